@@ -4,17 +4,26 @@
 #include "../shared/c2dvector.h"
 #include <boost/tuple/tuple.hpp>
 #include <vector>
+#ifdef CELL_LIST_CSR
+	#include "../shared/cell-list.h"
+#endif
 
 class Pair_Set;
 
 class Cell{
 public:
-	vector<int> pid; // particle_id
+	#ifdef CELL_LIST_CSR
+		Cell_Particle_Ids pid; // particle_id, a window to the cell list of Find_Particle
+	#else
+		vector<int> pid; // particle_id
+	#endif
 
 	Cell();
 	~Cell();
 
-	void Add(int p); // Add a particle id to the list of pid of this cell.
+	#ifndef CELL_LIST_CSR
+		void Add(int p); // Add a particle id to the list of pid of this cell.
+	#endif
 	void Add_Pairs_Self(Pair_Set* ps);
 	void Add_Pairs(Cell* c, Pair_Set* ps);
 };
@@ -100,12 +109,32 @@ bool Pair_Set::Find_Particle(Real input_r_min, Real input_r_max, int t)
 	for (int i = 0; i < grid_dim_x; i++)
 		c[i] = new Cell[grid_dim_y];
 	
+	#ifdef CELL_LIST_CSR
+		int Ns = sceneset->scene[step].Ns;
+		vector<int> particle_id(Ns), cell_id(Ns);
+	#endif
 	for (int i = 0; i < sceneset->scene[step].Ns; i++)
 	{
 		int x = (int) floor((sceneset->scene[step].sparticle[i].r.x + sceneset->L_min.x)*grid_dim_x / (2*sceneset->L_min.x));
 		int y = (int) floor((sceneset->scene[step].sparticle[i].r.y + sceneset->L_min.y)*grid_dim_y / (2*sceneset->L_min.y));
-		c[x][y].Add(i);
+		#ifdef CELL_LIST_CSR
+			particle_id[i] = i;
+			cell_id[i] = x*grid_dim_y + y;
+		#else
+			c[x][y].Add(i);
+		#endif
 	}
+	#ifdef CELL_LIST_CSR
+		Cell_List cell_list;
+		cell_list.Init(grid_dim_x*grid_dim_y);
+		if (Ns > 0)
+			cell_list.Build(&(particle_id[0]), &(cell_id[0]), Ns);
+		else
+			cell_list.Build(NULL, NULL, 0);
+		for (int x = 0; x < grid_dim_x; x++)
+			for (int y = 0; y < grid_dim_y; y++)
+				c[x][y].pid.Set(cell_list.Begin(x*grid_dim_y + y), cell_list.Size(x*grid_dim_y + y));
+	#endif
 
 	for (int x = 0; x < grid_dim_x; x++)
 		for (int y = 0; y < grid_dim_y; y++)
@@ -182,10 +211,12 @@ Cell::~Cell()
 	pid.clear();
 }
 
+#ifndef CELL_LIST_CSR
 void Cell::Add(int p)
 {
 	pid.push_back(p);
 }
+#endif
 
 void Cell::Add_Pairs_Self(Pair_Set* ps)
 {
@@ -67,6 +67,10 @@ Box::Box()
 {
 	N = 0;
 	particle = new Particle[max_N];
+	#ifdef PHILOX_RNG
+		for (int i = 0; i < max_N; i++)
+			particle[i].id = i;
+	#endif
 	r_old = new C2DVector[max_N];
 	theta_old = new Real[max_N];
 }
@@ -81,7 +85,7 @@ void Box::Init_Topology()
 // Sync positions of the particles with other nodes
 void Box::Sync()
 {
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 	thisnode->Root_Bcast();
 // Any node update cells, knowing particles and their cell that they are inside.
 	thisnode->Full_Update_Cells();
@@ -93,7 +97,7 @@ void Box::Sync()
 	for (int i = 0; i < N; i++)
 		particle[i].r_original = particle[i].r;
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 }
 
 
@@ -123,7 +127,7 @@ void Box::Init(Node* input_node, const int input_Ns, const int input_Nm)
 
 // Buliding up info stream. In next versions we will take this part out of box, making our libraries more abstract for any simulation of SPP.
 	info.str("");
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 }
 
 
@@ -176,7 +180,7 @@ bool Box::Positioning_Particles(Node* input_node, const string input_name)
 
 // Buliding up info stream. In next versions we will take this part out of box, making our libraries more abstract for any simulation of SPP.
 	info.str("");
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 
 	return (true);
 }
@@ -199,7 +203,7 @@ void Box::Interact_Membrane_Beads()
 void Box::Interact()
 {
 	thisnode->Send_Receive_Data();
-	MPI_Barrier(MPI_COMM_WORLD);
+	thisnode->Step_Barrier();
 
 	#ifdef verlet_list
 // with verlet list:
@@ -238,18 +242,18 @@ void Box::One_Step()
 		Interact_Membrane_Beads();
 		Interact();
 		Move();
-		MPI_Barrier(MPI_COMM_WORLD);
+		thisnode->Step_Barrier();
 	#else
 		Interact_Membrane_Beads();
 		Interact();
 		Move_Runge_Kutta2_1();
 
-		MPI_Barrier(MPI_COMM_WORLD);
+		thisnode->Step_Barrier();
 
 		Interact_Membrane_Beads();
 		Interact();
 		Move_Runge_Kutta2_2();
-		MPI_Barrier(MPI_COMM_WORLD);
+		thisnode->Step_Barrier();
 	#endif
 	t += dt;
 }
@@ -263,19 +267,19 @@ void Box::Multi_Step(int steps)
 			Interact_Membrane_Beads();
 			Interact();
 			Move();
-			MPI_Barrier(MPI_COMM_WORLD); // Barier guranty that the move step of all particles is done. Therefor in interact function we are using updated particles.
+			thisnode->Step_Barrier(); // Barier guranty that the move step of all particles is done. Therefor in interact function we are using updated particles.
 		#else		
 			Interact_Membrane_Beads();
 			Interact();
 			Move_Runge_Kutta2_1();
 
-			MPI_Barrier(MPI_COMM_WORLD);
+			thisnode->Step_Barrier();
 
 			Interact_Membrane_Beads();
 			Interact();
 			Move_Runge_Kutta2_2();
 
-			MPI_Barrier(MPI_COMM_WORLD); // Barier guranty that the move step of all particles is done. Therefor in interact function we are using updated particles.
+			thisnode->Step_Barrier(); // Barier guranty that the move step of all particles is done. Therefor in interact function we are using updated particles.
 		#endif
 	}
 	t += dt*steps;
@@ -393,9 +397,9 @@ void Box::Compute_All_Variables() // Compute center of mass position and speed,
 	buffer[15] = sw_l;
 	buffer[16] = sw_spin;
 
-	MPI_Barrier(MPI_COMM_WORLD);
-	MPI_Reduce(&buffer, &buffer_sum, n_data, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
+	MPI_Reduce(&buffer, &buffer_sum, n_data, MPI_DOUBLE, MPI_SUM, 0, node_comm);
+	MPI_Barrier(node_comm);
 
 	mb_r_cm.x = buffer_sum[0] / Nm;
 	mb_r_cm.y = buffer_sum[1] / Nm;
@@ -475,7 +479,7 @@ std::ostream& operator<<(std::ostream& os, Box* box)
 //			cout << i << "\t" << setprecision(100) << box->particle[i].theta << endl;
 		}
 	}
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 }
 
 // Reading the particle information (position and velocities) from a standard input stream (probably a file).
@@ -490,7 +494,7 @@ std::istream& operator>>(std::istream& is, Box* box)
 			is >> box->particle[i].v;
 		}
 	}
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 }
 
 #endif
@@ -3,6 +3,8 @@
 
 #include "mpi.h"
 
+MPI_Comm node_comm = MPI_COMM_WORLD; // The communicator of the nodes. With CART_TOPOLOGY it is the grid of nodes that Node::Init_Topology makes, the rank of a process there may be different from its rank in MPI_COMM_WORLD.
+
 struct Boundary{
 // Any node has a list of boundaries. Each boundary is aware of the node that it belongs to (this_node_id) and the node that it is connecting this_node_id to (that_node_id).
 	int this_node_id;
@@ -12,6 +14,23 @@ struct Boundary{
 	bool box_edge; // This give information about the boundary that is at the edge of the box or not
 	vector<Cell*> this_cell; // the cells at the boundary that are in the this_node
 	vector<Cell*> that_cell; // the cells at the boundary that are in the that_node
+	#ifdef CELL_LIST_CSR
+		vector<int> received_pid; // particle ids of that_cells in a row, the pid of each that_cell is a window to this buffer
+	#endif
+	#ifdef NONBLOCKING_HALO
+		vector<double> send_buffer, receive_buffer; // buffers of the non-blocking exchange of the data
+	#endif
+	#ifdef PERSISTENT_HALO
+		MPI_Request send_request, receive_request; // persistent requests of the exchange of the data, they are started at each exchange
+		int send_request_size, receive_request_size; // the number of doubles that the requests are made for, -1 if there is no request
+	#endif
+	#ifdef BARRIER_FREE
+		vector<int> send_cell_size, receive_cell_size, send_index, receive_index; // buffers of the non-blocking exchange of the particle ids
+	#endif
+	#ifdef MIGRATION_UPDATE
+		vector<int> old_this_pid, old_this_size, old_that_pid, old_that_size; // the particles of this_cells and that_cells before the cell update, cell after cell
+		vector<int> send_delta, receive_delta; // buffers of the departures and arrivals of the boundary cells
+	#endif
 
 	Boundary();
 	Boundary(const Boundary& b); // Copy constructor, because we want to manipulate boundaries by a vector (pushback) we need a copy constructor.
@@ -20,8 +39,31 @@ struct Boundary{
 
 	void Send_Data(); // Send the data of particles in this_cell of boundary of this_node to that_cell of boundary of that_node. We suppose that the particle indices of that_cells are known exactly and use this to enhance our computation.
 	void Receive_Data(); // Receive data of particles inside that cell wich are inside this_cell of that_node. We suppose that the particle indices of that_cells are known exactly and use this to enhance our computation.
+	int Send_Size() const; // Number of doubles that Send_Data sends
+	int Receive_Size() const; // Number of doubles that Receive_Data receives
+	void Pack_Data(double* data_buffer) const; // Writing the data of the particles of this_cell to the buffer
+	void Unpack_Data(const double* data_buffer); // Reading the data of the particles of that_cell from the buffer
+	#ifdef NONBLOCKING_HALO
+		void Post_Send_Data(MPI_Request* request); // Packing and starting a non-blocking send of the data of this_cell
+		void Post_Receive_Data(MPI_Request* request); // Starting a non-blocking receive of the data of that_cell
+		void Finish_Receive_Data(); // Unpacking the received data after the receive is complete
+	#endif
 	void Send_Particle_Ids(); // Send particle ids that are inside this_cell to the neighboring node. Befor sending data each node must be aware of its neighboring node particles at boundary.
 	void Receive_Particle_Ids(); // Receive particle ids that are inside that_cell of neighboring node to this cell. Befor sending data each node must be aware of its neighboring node particles at boundary.
+	void Pack_Particle_Ids(int* cell_size, int* index_buffer) const; // Writing the particle number of each this_cell and their ids to the buffers
+	void Unpack_Particle_Ids(const int* cell_size, int* index_buffer); // Giving the received ids to that_cells, with CELL_LIST_CSR index_buffer must be received_pid
+	#ifdef BARRIER_FREE
+		void Post_Send_Cell_Size(MPI_Request* request); // Packing the ids and starting a non-blocking send of the particle number of each this_cell
+		void Post_Send_Particle_Ids(MPI_Request* request); // Starting a non-blocking send of the packed ids
+		void Post_Receive_Cell_Size(MPI_Request* request); // The first half of the non-blocking receive of the ids
+		void Post_Receive_Particle_Ids(MPI_Request* request); // The second half, it must be called after the cell sizes are received
+		void Finish_Receive_Particle_Ids();
+	#endif
+	#ifdef MIGRATION_UPDATE
+		void Save_Cell_Lists(); // Keeping the particles of this_cells and that_cells before the cells are updated
+		void Post_Send_Migration(const vector<Cell*>& new_cell, MPI_Request* request); // Packing the departures and arrivals of each this_cell (new_cell is the cell of each slot after the update) and starting a non-blocking send
+		void Receive_Migration(); // Receiving the departures and arrivals of each that_cell and applying them to the old that_cells
+	#endif
 	void Print_Info();
 };
 
@@ -30,11 +72,23 @@ Boundary::Boundary()
 	tag = -1;
 	box_edge = false;
 	is_active = true;
+	#ifdef PERSISTENT_HALO
+		send_request = MPI_REQUEST_NULL;
+		receive_request = MPI_REQUEST_NULL;
+		send_request_size = -1;
+		receive_request_size = -1;
+	#endif
 }
 
 // Copy constructor
 Boundary::Boundary(const Boundary& b)
 {
+	#ifdef PERSISTENT_HALO
+		send_request = MPI_REQUEST_NULL; // The requests belong to the buffers of b, the copy makes its own
+		receive_request = MPI_REQUEST_NULL;
+		send_request_size = -1;
+		receive_request_size = -1;
+	#endif
 	Delete();
 	this_node_id = b.this_node_id;
 	that_node_id = b.that_node_id;
@@ -58,18 +112,44 @@ void Boundary::Delete()
 	tag = -1;
 	this_node_id = -1;
 	that_node_id = -1;
+	#ifdef PERSISTENT_HALO
+// The nodes may be destroyed after MPI_Finalize, then the requests are not freed.
+		int finalized;
+		MPI_Finalized(&finalized);
+		if (!finalized)
+		{
+			if (send_request != MPI_REQUEST_NULL)
+				MPI_Request_free(&send_request);
+			if (receive_request != MPI_REQUEST_NULL)
+				MPI_Request_free(&receive_request);
+		}
+		send_request = MPI_REQUEST_NULL;
+		receive_request = MPI_REQUEST_NULL;
+		send_request_size = -1;
+		receive_request_size = -1;
+	#endif
 }
 
-void Boundary::Send_Data()
+int Boundary::Send_Size() const
 {
-// First we need to find the data size.
 	int data_size = 0;
 // Go over all bondary cells:
 	for (int i = 0; i < this_cell.size(); i++)
 		data_size += this_cell[i]->pid.size(); // Summing particles of each neighboring cell
-	data_size *= dof; // each particle has 3 double values (x,y and theta).
-	double* data_buffer = new double[data_size]; // Allocating buffer array
+	return (data_size*dof); // each particle has dof double values (x,y,theta, ...).
+}
 
+int Boundary::Receive_Size() const
+{
+	int data_size = 0;
+// We go over the cells of neighboring node at the boundary to sum the number of particles.
+	for (int i = 0; i < that_cell.size(); i++)
+		data_size += that_cell[i]->pid.size();
+	return (data_size*dof);
+}
+
+void Boundary::Pack_Data(double* data_buffer) const
+{
 	int shift = 0; // We need to have a track of the last element of data_buffer that we wrote.
 // Go over particle ids of each boundary cell
 	for (int i = 0; i < this_cell.size(); i++)
@@ -78,92 +158,174 @@ void Boundary::Send_Data()
 		{
 			int index = this_cell[i]->pid[j]; // This is just for convinience. Save pid of j'th particle in i'th this_cell to index.
 // save the index'th particle data to data_buffer
-			data_buffer[shift+dof*j] = this_cell[i]->particle[index].r.x; // The particles could be accessed through Cell class
-			data_buffer[shift+dof*j+1] = this_cell[i]->particle[index].r.y;
-			data_buffer[shift+dof*j+2] = this_cell[i]->particle[index].theta;
-			#ifdef NonPeriodicCompute
-				data_buffer[shift+dof*j+3] = this_cell[i]->particle[index].r_original.x;
-				data_buffer[shift+dof*j+4] = this_cell[i]->particle[index].r_original.y;
+			#ifdef SOA_STORE
+				data_buffer[shift+dof*j] = Cell::store->x[index]; // The particles could be accessed through the store of Cell class
+				data_buffer[shift+dof*j+1] = Cell::store->y[index];
+				data_buffer[shift+dof*j+2] = Cell::store->theta[index];
+				data_buffer[shift+dof*j+3] = Cell::store->x_original[index];
+				data_buffer[shift+dof*j+4] = Cell::store->y_original[index];
+			#else
+				data_buffer[shift+dof*j] = this_cell[i]->particle[index].r.x; // The particles could be accessed through Cell class
+				data_buffer[shift+dof*j+1] = this_cell[i]->particle[index].r.y;
+				data_buffer[shift+dof*j+2] = this_cell[i]->particle[index].theta;
+				#ifdef NonPeriodicCompute
+					data_buffer[shift+dof*j+3] = this_cell[i]->particle[index].r_original.x;
+					data_buffer[shift+dof*j+4] = this_cell[i]->particle[index].r_original.y;
+				#endif
 			#endif
 		}
 		shift += dof*this_cell[i]->pid.size(); // the last element id must be added with amount of data that we added in the for loop.
 	}
-	MPI_Send(data_buffer,data_size,MPI_DOUBLE,that_node_id,tag,MPI_COMM_WORLD);
-	delete [] data_buffer;
 }
 
-void Boundary::Receive_Data()
+void Boundary::Unpack_Data(const double* data_buffer)
 {
-// First we need to find the data size that thisnode is receiving.
-	int data_size = 0;
-// We go over the cells of neighboring node at the boundary to sum the number of particles.
-	for (int i = 0; i < that_cell.size(); i++)
-		data_size += that_cell[i]->pid.size();
-	data_size *= dof; // each particle has 3 double values (x,y and theta).
-	double* data_buffer = new double[data_size]; // Allocating space
-	MPI_Status status; // status is required in MPI_Recv call
-	MPI_Recv(data_buffer,data_size,MPI_DOUBLE,that_node_id,tag,MPI_COMM_WORLD,&status); // receiving data
 	int shift = 0; // We need to have a track of the last element of data_buffer that we wrote.
 	for (int i = 0; i < that_cell.size(); i++)
 	{
 		for (int j = 0; j < that_cell[i]->pid.size(); j++)
 		{
 			int index = that_cell[i]->pid[j];
-			that_cell[i]->particle[index].r.x = data_buffer[shift+dof*j];
-			that_cell[i]->particle[index].r.y = data_buffer[shift+dof*j+1];
-			that_cell[i]->particle[index].theta = data_buffer[shift+dof*j+2];
-			#ifdef NonPeriodicCompute
-				that_cell[i]->particle[index].r_original.x = data_buffer[shift+dof*j+3];
-				that_cell[i]->particle[index].r_original.y = data_buffer[shift+dof*j+4];
-			#endif
+			#ifdef SOA_STORE
+				Cell::store->x[index] = data_buffer[shift+dof*j];
+				Cell::store->y[index] = data_buffer[shift+dof*j+1];
+				Cell::store->theta[index] = data_buffer[shift+dof*j+2];
+				Cell::store->x_original[index] = data_buffer[shift+dof*j+3];
+				Cell::store->y_original[index] = data_buffer[shift+dof*j+4];
 
-			that_cell[i]->particle[index].v.x = cos(that_cell[i]->particle[index].theta); // Optimization required, computing every particle velocities is not a good idea. A first step is computing the velocity of particles that are within the node, not the one on the neighboring cells of that node.
-			that_cell[i]->particle[index].v.y = sin(that_cell[i]->particle[index].theta); // Optimization required, computing every particle velocities is not a good idea. A first step is computing the velocity of particles that are within the node, not the one on the neighboring cells of that node.
-			that_cell[i]->particle[index].Reset(); // eperimental for debug, it seems that this is needed!
+				Cell::store->vx[index] = cos(Cell::store->theta[index]);
+				Cell::store->vy[index] = sin(Cell::store->theta[index]);
+				Cell::store->Reset(index);
+			#else
+				that_cell[i]->particle[index].r.x = data_buffer[shift+dof*j];
+				that_cell[i]->particle[index].r.y = data_buffer[shift+dof*j+1];
+				that_cell[i]->particle[index].theta = data_buffer[shift+dof*j+2];
+				#ifdef NonPeriodicCompute
+					that_cell[i]->particle[index].r_original.x = data_buffer[shift+dof*j+3];
+					that_cell[i]->particle[index].r_original.y = data_buffer[shift+dof*j+4];
+				#endif
+
+				that_cell[i]->particle[index].v.x = cos(that_cell[i]->particle[index].theta); // Optimization required, computing every particle velocities is not a good idea. A first step is computing the velocity of particles that are within the node, not the one on the neighboring cells of that node.
+				that_cell[i]->particle[index].v.y = sin(that_cell[i]->particle[index].theta); // Optimization required, computing every particle velocities is not a good idea. A first step is computing the velocity of particles that are within the node, not the one on the neighboring cells of that node.
+				that_cell[i]->particle[index].Reset(); // eperimental for debug, it seems that this is needed!
+			#endif
 		}
 		shift += dof*that_cell[i]->pid.size();
 	}
+}
+
+void Boundary::Send_Data()
+{
+	int data_size = Send_Size();
+	double* data_buffer = new double[data_size]; // Allocating buffer array
+	Pack_Data(data_buffer);
+	MPI_Send(data_buffer,data_size,MPI_DOUBLE,that_node_id,tag,node_comm);
 	delete [] data_buffer;
 }
 
-void Boundary::Send_Particle_Ids()
+void Boundary::Receive_Data()
 {
-// First we need to find the data size.
-	int index_size = 0;
-// Go over all bondary cells:
-	for (int i = 0; i < this_cell.size(); i++)
-		index_size += this_cell[i]->pid.size(); // Summing particles of each neighboring cell
-	int* index_buffer = new int[index_size]; // Allocating buffer array
-	int* cell_size = new int[this_cell.size()]; // Allocating a buffer of each cell particle count.
+	int data_size = Receive_Size();
+	double* data_buffer = new double[data_size]; // Allocating space
+	MPI_Status status; // status is required in MPI_Recv call
+	MPI_Recv(data_buffer,data_size,MPI_DOUBLE,that_node_id,tag,node_comm,&status); // receiving data
+	Unpack_Data(data_buffer);
+	delete [] data_buffer;
+}
+
+#ifdef NONBLOCKING_HALO
+// The buffers must live until the request is complete, so they are members of the boundary.
+void Boundary::Post_Send_Data(MPI_Request* request)
+{
+	#ifdef PERSISTENT_HALO
+// The size changes only at the cell updates, the buffer only grows so between the updates nothing is allocated.
+		int data_size = Send_Size();
+		if (data_size != send_request_size)
+		{
+			if (send_request != MPI_REQUEST_NULL)
+				MPI_Request_free(&send_request);
+			if ((int) send_buffer.size() < max(data_size, 1))
+				send_buffer.resize(max(data_size, 1));
+			MPI_Send_init(&(send_buffer[0]),data_size,MPI_DOUBLE,that_node_id,tag,node_comm,&send_request);
+			send_request_size = data_size;
+		}
+		Pack_Data(&(send_buffer[0]));
+		MPI_Start(&send_request);
+		*request = send_request;
+	#else
+	send_buffer.resize(max(Send_Size(), 1));
+	Pack_Data(&(send_buffer[0]));
+	MPI_Isend(&(send_buffer[0]),Send_Size(),MPI_DOUBLE,that_node_id,tag,node_comm,request);
+	#endif
+}
+
+void Boundary::Post_Receive_Data(MPI_Request* request)
+{
+	#ifdef PERSISTENT_HALO
+		int data_size = Receive_Size();
+		if (data_size != receive_request_size)
+		{
+			if (receive_request != MPI_REQUEST_NULL)
+				MPI_Request_free(&receive_request);
+			if ((int) receive_buffer.size() < max(data_size, 1))
+				receive_buffer.resize(max(data_size, 1));
+			MPI_Recv_init(&(receive_buffer[0]),data_size,MPI_DOUBLE,that_node_id,tag,node_comm,&receive_request);
+			receive_request_size = data_size;
+		}
+		MPI_Start(&receive_request);
+		*request = receive_request; // A persistent request stays allocated after the wait, the copy in the request list of the node refers to the same request
+	#else
+	receive_buffer.resize(max(Receive_Size(), 1));
+	MPI_Irecv(&(receive_buffer[0]),Receive_Size(),MPI_DOUBLE,that_node_id,tag,node_comm,request);
+	#endif
+}
+
+void Boundary::Finish_Receive_Data()
+{
+	Unpack_Data(&(receive_buffer[0]));
+}
+#endif
 
+void Boundary::Pack_Particle_Ids(int* cell_size, int* index_buffer) const
+{
 	int shift = 0; // We need to have a track of the last element of data_buffer that we wrote.
 // Go over particle ids of each boundary cell
 	for (int i = 0; i < this_cell.size(); i++)
 	{
 		for (int j = 0; j < this_cell[i]->pid.size(); j++)
-			index_buffer[shift+j] = this_cell[i]->pid[j];
+			#ifdef SPATIAL_REORDER
+				index_buffer[shift+j] = Cell::store->id[this_cell[i]->pid[j]]; // Slots are local to each node, the ids are sent
+			#else
+				index_buffer[shift+j] = this_cell[i]->pid[j];
+			#endif
 		cell_size[i] = this_cell[i]->pid.size(); // Saving particle number of i'th cell of thisnode at boundary.
 		shift += this_cell[i]->pid.size(); // the last element id must be added with amount of data that we added in the for loop.
 	}
-	MPI_Send(cell_size,this_cell.size(),MPI_INT,that_node_id,tag,MPI_COMM_WORLD);
-	MPI_Send(index_buffer,index_size,MPI_INT,that_node_id,tag,MPI_COMM_WORLD);
-	delete [] index_buffer;
-	delete [] cell_size;
 }
 
-void Boundary::Receive_Particle_Ids()
+void Boundary::Unpack_Particle_Ids(const int* cell_size, int* index_buffer)
 {
-	int* cell_size = new int[that_cell.size()]; // Allocating a buffer of each cell particle count.
-
-	MPI_Status status; // status is required in MPI_Recv call
-	MPI_Recv(cell_size, that_cell.size(),MPI_INT,that_node_id,tag,MPI_COMM_WORLD,&status); // Receiving particle number within each boundary cell
-
 	int data_size = 0;
 	for (int i = 0; i < that_cell.size(); i++)
 		data_size += cell_size[i];
-	int* index_buffer = new int[data_size]; // Allocating space
-	MPI_Recv(index_buffer,data_size,MPI_DOUBLE,that_node_id,tag,MPI_COMM_WORLD,&status); // Receiving Indices
+	#ifdef CELL_LIST_CSR
+// The ids are already sorted by cell, so they are received to the buffer of the boundary and the cells point to their part of it.
+		#ifdef SPATIAL_REORDER
+			for (int j = 0; j < data_size; j++)
+				#ifdef DISTRIBUTED_STORE
+					index_buffer[j] = Cell::store->Local_Slot(index_buffer[j]); // A particle that is new to thisnode gets a slot, its data comes with the next Send_Receive_Data
+				#else
+				index_buffer[j] = Cell::store->slot[index_buffer[j]];
+				#endif
+		#endif
 
+		int shift = 0;
+		for (int i = 0; i < that_cell.size(); i++)
+		{
+			that_cell[i]->pid.Set(&(index_buffer[shift]), cell_size[i]);
+			shift += cell_size[i];
+		}
+	#else
 	int shift = 0; // We need to have a track of the last element of data_buffer that we wrote.
 	for (int i = 0; i < that_cell.size(); i++)
 	{
@@ -175,11 +337,204 @@ void Boundary::Receive_Particle_Ids()
 		}
 		shift += that_cell[i]->pid.size();
 	}
+	#endif
+}
 
-	delete [] cell_size;
+void Boundary::Send_Particle_Ids()
+{
+// First we need to find the data size.
+	int index_size = 0;
+// Go over all bondary cells:
+	for (int i = 0; i < this_cell.size(); i++)
+		index_size += this_cell[i]->pid.size(); // Summing particles of each neighboring cell
+	int* index_buffer = new int[index_size]; // Allocating buffer array
+	int* cell_size = new int[this_cell.size()]; // Allocating a buffer of each cell particle count.
+
+	Pack_Particle_Ids(cell_size, index_buffer);
+	MPI_Send(cell_size,this_cell.size(),MPI_INT,that_node_id,tag,node_comm);
+	MPI_Send(index_buffer,index_size,MPI_INT,that_node_id,tag,node_comm);
 	delete [] index_buffer;
+	delete [] cell_size;
+}
+
+void Boundary::Receive_Particle_Ids()
+{
+	int* cell_size = new int[that_cell.size()]; // Allocating a buffer of each cell particle count.
+
+	MPI_Status status; // status is required in MPI_Recv call
+	MPI_Recv(cell_size, that_cell.size(),MPI_INT,that_node_id,tag,node_comm,&status); // Receiving particle number within each boundary cell
+
+	int data_size = 0;
+	for (int i = 0; i < that_cell.size(); i++)
+		data_size += cell_size[i];
+	#ifdef CELL_LIST_CSR
+		received_pid.resize(data_size > 0 ? data_size : 1);
+		MPI_Recv(&(received_pid[0]),data_size,MPI_INT,that_node_id,tag,node_comm,&status); // Receiving Indices
+		Unpack_Particle_Ids(cell_size, &(received_pid[0]));
+	#else
+		int* index_buffer = new int[data_size]; // Allocating space
+		MPI_Recv(index_buffer,data_size,MPI_INT,that_node_id,tag,node_comm,&status); // Receiving Indices
+		Unpack_Particle_Ids(cell_size, index_buffer);
+		delete [] index_buffer;
+	#endif
+
+	delete [] cell_size;
 }
 
+#ifdef BARRIER_FREE
+// The sizes of all boundaries are sent before the ids of any boundary, so the receiver that waits for all sizes before posting the receives of the ids matches them in order.
+void Boundary::Post_Send_Cell_Size(MPI_Request* request)
+{
+	int index_size = 0;
+	for (int i = 0; i < this_cell.size(); i++)
+		index_size += this_cell[i]->pid.size();
+	send_cell_size.resize(max((int) this_cell.size(), 1));
+	send_index.resize(max(index_size, 1));
+	Pack_Particle_Ids(&(send_cell_size[0]), &(send_index[0]));
+	MPI_Isend(&(send_cell_size[0]),this_cell.size(),MPI_INT,that_node_id,tag,node_comm,request);
+}
+
+void Boundary::Post_Send_Particle_Ids(MPI_Request* request)
+{
+	int index_size = 0;
+	for (int i = 0; i < this_cell.size(); i++)
+		index_size += send_cell_size[i];
+	MPI_Isend(&(send_index[0]),index_size,MPI_INT,that_node_id,tag,node_comm,request);
+}
+
+void Boundary::Post_Receive_Cell_Size(MPI_Request* request)
+{
+	receive_cell_size.resize(max((int) that_cell.size(), 1));
+	MPI_Irecv(&(receive_cell_size[0]),that_cell.size(),MPI_INT,that_node_id,tag,node_comm,request);
+}
+
+void Boundary::Post_Receive_Particle_Ids(MPI_Request* request)
+{
+	int data_size = 0;
+	for (int i = 0; i < that_cell.size(); i++)
+		data_size += receive_cell_size[i];
+	#ifdef CELL_LIST_CSR
+		received_pid.resize(max(data_size, 1));
+		MPI_Irecv(&(received_pid[0]),data_size,MPI_INT,that_node_id,tag,node_comm,request);
+	#else
+		receive_index.resize(max(data_size, 1));
+		MPI_Irecv(&(receive_index[0]),data_size,MPI_INT,that_node_id,tag,node_comm,request);
+	#endif
+}
+
+void Boundary::Finish_Receive_Particle_Ids()
+{
+	#ifdef CELL_LIST_CSR
+		Unpack_Particle_Ids(&(receive_cell_size[0]), &(received_pid[0]));
+	#else
+		Unpack_Particle_Ids(&(receive_cell_size[0]), &(receive_index[0]));
+	#endif
+}
+#endif
+
+#ifdef MIGRATION_UPDATE
+void Boundary::Save_Cell_Lists()
+{
+	old_this_pid.clear();
+	old_this_size.resize(this_cell.size());
+	for (int i = 0; i < this_cell.size(); i++)
+	{
+		for (int j = 0; j < this_cell[i]->pid.size(); j++)
+			old_this_pid.push_back(this_cell[i]->pid[j]);
+		old_this_size[i] = this_cell[i]->pid.size();
+	}
+	old_that_pid.clear();
+	old_that_size.resize(that_cell.size());
+	for (int i = 0; i < that_cell.size(); i++)
+	{
+		for (int j = 0; j < that_cell[i]->pid.size(); j++)
+			old_that_pid.push_back(that_cell[i]->pid[j]);
+		old_that_size[i] = that_cell[i]->pid.size();
+	}
+}
+
+// After the update the particles that stayed in a cell are at its beginning in their old order and the arrivals follow them, so the message of each this_cell is: the number of departures, their places in the old cell, the number of arrivals and their ids.
+void Boundary::Post_Send_Migration(const vector<Cell*>& new_cell, MPI_Request* request)
+{
+	send_delta.clear();
+	int shift = 0;
+	for (int i = 0; i < this_cell.size(); i++)
+	{
+		int count_place = send_delta.size();
+		send_delta.push_back(0);
+		for (int k = 0; k < old_this_size[i]; k++)
+			if (new_cell[old_this_pid[shift+k]] != this_cell[i])
+				send_delta.push_back(k);
+		int departed = send_delta.size() - count_place - 1;
+		send_delta[count_place] = departed;
+
+		int stayed = old_this_size[i] - departed;
+		send_delta.push_back(this_cell[i]->pid.size() - stayed);
+		for (int j = stayed; j < this_cell[i]->pid.size(); j++)
+			#ifdef SPATIAL_REORDER
+				send_delta.push_back(Cell::store->id[this_cell[i]->pid[j]]);
+			#else
+				send_delta.push_back(this_cell[i]->pid[j]);
+			#endif
+		shift += old_this_size[i];
+	}
+	int delta_size = send_delta.size();
+	send_delta.resize(max(delta_size, 1));
+	MPI_Isend(&(send_delta[0]),delta_size,MPI_INT,that_node_id,tag,node_comm,request);
+}
+
+// The length of the message is not known, so it is probed. The messages of the boundaries that have the same neighbor and tag are matched by their order like the other exchanges.
+void Boundary::Receive_Migration()
+{
+	MPI_Status status; // status is required in MPI_Recv call
+	MPI_Probe(that_node_id,tag,node_comm,&status);
+	int delta_size;
+	MPI_Get_count(&status,MPI_INT,&delta_size);
+	receive_delta.resize(max(delta_size, 1));
+	MPI_Recv(&(receive_delta[0]),delta_size,MPI_INT,that_node_id,tag,node_comm,&status);
+
+	vector<int> new_pid, cell_size(that_cell.size());
+	new_pid.reserve(old_that_pid.size() + delta_size);
+	int shift = 0, read = 0;
+	for (int i = 0; i < that_cell.size(); i++)
+	{
+		int first = new_pid.size();
+		int departed = receive_delta[read++];
+		int d = 0; // the next departure, the places are increasing
+		for (int k = 0; k < old_that_size[i]; k++)
+			if ((d < departed) && (receive_delta[read+d] == k))
+				d++;
+			else
+				new_pid.push_back(old_that_pid[shift+k]);
+		read += departed;
+
+		int arrived = receive_delta[read++];
+		for (int j = 0; j < arrived; j++)
+			#ifdef SPATIAL_REORDER
+				#ifdef DISTRIBUTED_STORE
+					new_pid.push_back(Cell::store->Local_Slot(receive_delta[read++])); // A particle that is new to thisnode gets a slot, its data comes with the next Send_Receive_Data
+				#else
+				new_pid.push_back(Cell::store->slot[receive_delta[read++]]);
+				#endif
+			#else
+				new_pid.push_back(receive_delta[read++]);
+			#endif
+		cell_size[i] = new_pid.size() - first;
+		shift += old_that_size[i];
+	}
+
+	received_pid.swap(new_pid);
+	if (received_pid.size() == 0)
+		received_pid.push_back(0);
+	shift = 0;
+	for (int i = 0; i < that_cell.size(); i++)
+	{
+		that_cell[i]->pid.Set(&(received_pid[shift]), cell_size[i]);
+		shift += cell_size[i];
+	}
+}
+#endif
+
 void Boundary::Print_Info()
 {
 	for (int i = 0; i < that_cell.size(); i++)
@@ -49,9 +49,30 @@ public:
 
 	void One_Step(); // One full step, composed of interaction computation and move.
 	void Multi_Step(int steps); // Several steps befor a cell upgrade.
+	#ifdef VERLET_SKIN
+		void Verlet_Update(); // Updating the cells and the neighbor list if a particle has moved more than half of the skin
+	#endif
 	void Multi_Step(int steps, int interval); // Several steps with a cell upgrade call after each interval.
 	void Translate(C2DVector d); // Translate position of all particles with vector d
+	#ifdef LOAD_BALANCE
+		int balance_counter; // number of cell updates since the last load balance
+		void Balance_Load(); // Moving the cuts between the nodes if the load is not balanced, the particles go to their new nodes through the root
+	#endif
+	#ifdef AUTO_TUNE
+		void Auto_Tune(); // Timing several cell sizes and cell update periods from the current state and keeping the fastest safe one
+		Real Tune_Candidate(int period, int input_divisor_x, int input_divisor_y, const vector<Particle>& initial_particle, const gsl_rng* initial_rng, Real initial_t, Real* max_speed); // Time per step of one cell size and update period
+		#ifdef PHILOX_RNG
+			uint64_t tune_step; // The step counter of the random numbers when Auto_Tune is called
+		#endif
+	#endif
 	void Save_Polarization(std::ostream& os); // Save polarization of the particles inside the box
+	#ifdef MPIIO_OUTPUT
+		MPI_File frame_file; // The trajectory file that all nodes write to
+		MPI_Offset frame_offset; // The end of the last frame in frame_file
+		void Open_Frame_File(const string name, bool append); // Opening (or creating) the trajectory file by all nodes, if append is false the file is emptied
+		void Write_Frame(); // Save, the frame of operator<< is written by all nodes with one collective MPI-IO write, without a gather
+		void Close_Frame_File();
+	#endif
 
 	friend std::ostream& operator<<(std::ostream& os, Box* box); // Save
 	friend std::istream& operator>>(std::istream& is, Box* box); // Input
@@ -63,7 +84,14 @@ Box::Box()
 	Nm = 0;
 	density = 0;
 	wall_num = 0;
+	#ifdef LOAD_BALANCE
+		balance_counter = 0;
+	#endif
 	particle = new Particle[max_N];
+	#ifdef PHILOX_RNG
+		for (int i = 0; i < max_N; i++)
+			particle[i].id = i;
+	#endif
 }
 
 Box::Box(const Real input_Lx, const Real input_Ly, const Real input_phi)
@@ -72,6 +100,9 @@ Box::Box(const Real input_Lx, const Real input_Ly, const Real input_phi)
 	Nm = 0;
 	density = 0;
 	wall_num = 0;
+	#ifdef LOAD_BALANCE
+		balance_counter = 0;
+	#endif
 
 	Lbx = input_Lx;
 	Lby = input_Ly;
@@ -85,6 +116,10 @@ Box::Box(const Real input_Lx, const Real input_Ly, const Real input_phi)
 
 	max_N = (int) floor(4*1.1*input_Lx*input_Ly*input_rho);
 	particle = new Particle[max_N];
+	#ifdef PHILOX_RNG
+		for (int i = 0; i < max_N; i++)
+			particle[i].id = i;
+	#endif
 }
 
 
@@ -105,9 +140,9 @@ void Box::Init_Topology()
 // Sync positions of the particles with other nodes
 void Box::Sync()
 {
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 	thisnode->Root_Bcast();
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 // Any node update cells, knowing particles and their cell that they are inside.
 	thisnode->Full_Update_Cells();
 
@@ -115,7 +150,7 @@ void Box::Sync()
 	thisnode->Update_Neighbor_List();
 	#endif
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 }
 
 
@@ -147,7 +182,7 @@ void Box::Init(Node* input_node, Real input_density)
 
 // Buliding up info stream. In next versions we will take this part out of box, making our libraries more abstract for any simulation of SPP.
 	info.str("");
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 }
 
 
@@ -168,7 +203,7 @@ bool Box::Positioning_Particles(const string input_name)
 		command << name;
 		system(command.str().c_str());
 	}
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 
 	ifstream is;
 	is.open(address.str().c_str(), fstream::in);
@@ -187,7 +222,7 @@ bool Box::Positioning_Particles(const string input_name)
 	{
 		static int counter = 0;
 		is >> this;
-		MPI_Barrier(MPI_COMM_WORLD);
+		MPI_Barrier(node_comm);
 		counter++;
 	}
 
@@ -211,6 +246,9 @@ bool Box::Positioning_Particles(const string input_name)
 
 //	density = Ns / (Lx2*Ly2);
 
+	#ifdef DISTRIBUTED_STORE
+		thisnode->Root_Bcast(); // The nodes take their particles from the root
+	#endif
 	thisnode->Full_Update_Cells();
 
 	#ifdef verlet_list
@@ -237,7 +275,7 @@ void Box::Load(const State_Hyper_Vector& sv)
 		particle[i].v.y = sin(particle[i].theta);
 	}
 	sv.Set_C2DVector_Rand_Generator();
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 	thisnode->Root_Bcast();
 	thisnode->Full_Update_Cells();
 	#ifdef verlet_list
@@ -262,7 +300,7 @@ void Box::Save(State_Hyper_Vector& sv) const
 	}
 	sv.Get_C2DVector_Rand_Generator();
 // We need to make sure that indexing of particles are the same to exactly recompute the same values. Therefor at a saving we update cells and neighore list therefore if we load the same sv and update cells and neighore list we will come to the same indexing
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 	thisnode->Full_Update_Cells();
 	#ifdef verlet_list
 		thisnode->Update_Neighbor_List();
@@ -272,8 +310,33 @@ void Box::Save(State_Hyper_Vector& sv) const
 // Here the intractio of particles are computed that is the applied tourque to each particle.
 void Box::Interact()
 {
+	#ifdef LOAD_BALANCE
+		double start_time; // The interaction time of thisnode is measured without the waiting for the boundary data
+	#endif
+	#if defined(NONBLOCKING_HALO) && !defined(verlet_list)
+// The boundary data is in flight while the particles inside thisnode interact, Self_Interact does not touch the cells of the neighboring nodes.
+	thisnode->Post_Halo();
+	#ifdef LOAD_BALANCE
+		start_time = MPI_Wtime();
+	#endif
+	thisnode->Self_Interact(); // Sum up interaction of particles within thisnode
+	#ifdef LOAD_BALANCE
+		thisnode->interaction_time += MPI_Wtime() - start_time;
+	#endif
+	thisnode->Wait_Halo();
+	thisnode->Check_Node_Size();
+	#ifdef LOAD_BALANCE
+		start_time = MPI_Wtime();
+	#endif
+	thisnode->Boundary_Interact(); // Sum up interaction of particles in the neighboring nodes.
+	#else
 	thisnode->Send_Receive_Data();
-	MPI_Barrier(MPI_COMM_WORLD);
+	#ifndef NONBLOCKING_HALO
+		MPI_Barrier(node_comm);
+	#endif
+	#ifdef LOAD_BALANCE
+		start_time = MPI_Wtime();
+	#endif
 
 	#ifdef verlet_list
 // with verlet list:
@@ -283,6 +346,10 @@ void Box::Interact()
 	thisnode->Self_Interact(); // Sum up interaction of particles within thisnode
 	thisnode->Boundary_Interact(); // Sum up interaction of particles in the neighboring nodes.
 	#endif
+	#endif
+	#ifdef LOAD_BALANCE
+		thisnode->interaction_time += MPI_Wtime() - start_time;
+	#endif
 
 	#ifndef PERIODIC_BOUNDARY_CONDITION
 		#ifdef CIRCULAR_BOX
@@ -292,9 +359,16 @@ void Box::Interact()
 				for (int j = 0; j < thisnode->cell[x][y].pid.size(); j++)
 				{
 					int i = thisnode->cell[x][y].pid[j];
-					Real r = sqrt(particle[i].r.Square());
-					if (r > (Lx-1))
-						particle[i].torque += 40*Particle::g*(particle[i].v.y*particle[i].r.x - particle[i].v.x*particle[i].r.y) / (2*M_PI*r*(Lx-r));
+					#ifdef SOA_STORE
+						Particle_Store* s = &(thisnode->store);
+						Real r = sqrt(s->x[i]*s->x[i] + s->y[i]*s->y[i]);
+						if (r > (Lx-1))
+							s->torque[i] += 40*Particle::g*(s->vy[i]*s->x[i] - s->vx[i]*s->y[i]) / (2*M_PI*r*(Lx-r));
+					#else
+						Real r = sqrt(particle[i].r.Square());
+						if (r > (Lx-1))
+							particle[i].torque += 40*Particle::g*(particle[i].v.y*particle[i].r.x - particle[i].v.x*particle[i].r.y) / (2*M_PI*r*(Lx-r));
+					#endif
 				}
 		#else
 // Sum up interaction of the walls with the particles of thisnode (in the absence of periodic boundary condition)
@@ -302,7 +376,11 @@ void Box::Interact()
 			for (int x = thisnode->head_cell_idx; x < thisnode->tail_cell_idx; x++)
 				for (int y = thisnode->head_cell_idy; y < thisnode->tail_cell_idy; y++)
 					for (int j = 0; j < thisnode->cell[x][y].pid.size(); j++)
-						wall[i].Interact(&particle[thisnode->cell[x][y].pid[j]]);
+						#ifdef SOA_STORE
+							wall[i].Interact(&(thisnode->store), thisnode->cell[x][y].pid[j]);
+						#else
+							wall[i].Interact(&particle[thisnode->cell[x][y].pid[j]]);
+						#endif
 		#endif
 	#endif
 }
@@ -360,39 +438,56 @@ void Box::One_Step()
 		Interact();
 		Move_Runge_Kutta2_1();
 
-		MPI_Barrier(MPI_COMM_WORLD);
+		thisnode->Step_Barrier();
 
 		Interact();
 		Move_Runge_Kutta2_2();
-		MPI_Barrier(MPI_COMM_WORLD);
+		thisnode->Step_Barrier();
 	#else
 		#ifdef RUNGE_KUTTA4
 			Interact();
 			Move_Runge_Kutta4_1();
-			MPI_Barrier(MPI_COMM_WORLD);
+			thisnode->Step_Barrier();
 
 			Interact();
 			Move_Runge_Kutta4_2();
-			MPI_Barrier(MPI_COMM_WORLD);
+			thisnode->Step_Barrier();
 
 			Interact();
 			Move_Runge_Kutta4_3();
-			MPI_Barrier(MPI_COMM_WORLD);
+			thisnode->Step_Barrier();
 
 			Interact();
 			Move_Runge_Kutta4_4();
-			MPI_Barrier(MPI_COMM_WORLD);
+			thisnode->Step_Barrier();
 		#else
 			Interact();
 			Move();
-			MPI_Barrier(MPI_COMM_WORLD);
+			thisnode->Step_Barrier();
 		#endif
 	#endif
+	#ifdef VERLET_SKIN
+		Verlet_Update();
+	#endif
 
 	t += dt;
-	MPI_Barrier(MPI_COMM_WORLD);
+	#if defined(SOA_STORE) && !defined(DISTRIBUTED_STORE)
+		thisnode->Export_Store(); // The particle objects must be up to date for output and gathering. With DISTRIBUTED_STORE the gather reads the stores.
+	#endif
+	thisnode->Step_Barrier();
 }
 
+#ifdef VERLET_SKIN
+void Box::Verlet_Update()
+{
+	if (thisnode->Verlet_Expired())
+	{
+		thisnode->Quick_Update_Cells();
+		thisnode->Update_Neighbor_List();
+	}
+}
+#endif
+
 // Several steps befor a cell upgrade.
 void Box::Multi_Step(int steps)
 {
@@ -402,43 +497,60 @@ void Box::Multi_Step(int steps)
 			Interact();
 			Move_Runge_Kutta2_1();
 
-			MPI_Barrier(MPI_COMM_WORLD);
+			thisnode->Step_Barrier();
 
 			Interact();
 			Move_Runge_Kutta2_2();
-			MPI_Barrier(MPI_COMM_WORLD);
+			thisnode->Step_Barrier();
 		#else
 			#ifdef RUNGE_KUTTA4
 				Interact();
 				Move_Runge_Kutta4_1();
-				MPI_Barrier(MPI_COMM_WORLD);
+				thisnode->Step_Barrier();
 
 				Interact();
 				Move_Runge_Kutta4_2();
-				MPI_Barrier(MPI_COMM_WORLD);
+				thisnode->Step_Barrier();
 
 				Interact();
 				Move_Runge_Kutta4_3();
-				MPI_Barrier(MPI_COMM_WORLD);
+				thisnode->Step_Barrier();
 
 				Interact();
 				Move_Runge_Kutta4_4();
-				MPI_Barrier(MPI_COMM_WORLD);
+				thisnode->Step_Barrier();
 			#else
 				Interact();
 				Move();
-				MPI_Barrier(MPI_COMM_WORLD); // Barier guranty that the move step of all particles is done. Therefor in interact function we are using updated particles.
+				thisnode->Step_Barrier(); // Barier guranty that the move step of all particles is done. Therefor in interact function we are using updated particles.
 			#endif
 		#endif
+		#ifdef VERLET_SKIN
+			Verlet_Update();
+		#endif
 	}
 
 	t += dt*steps;
+// With VERLET_SKIN the cells are updated only when the list expires (Verlet_Update).
+	#ifndef VERLET_SKIN
 //	cout << "Updating cells" << endl;
 	thisnode->Quick_Update_Cells();
 //	cout << "Updating finished" << endl;
 	#ifdef verlet_list
 	thisnode->Update_Neighbor_List();
 	#endif
+	#endif
+	#if defined(SOA_STORE) && !defined(DISTRIBUTED_STORE)
+		thisnode->Export_Store(); // The particle objects must be up to date for output and gathering. With DISTRIBUTED_STORE the gather reads the stores.
+	#endif
+	#ifdef LOAD_BALANCE
+		balance_counter++;
+		if (balance_counter >= balance_period)
+		{
+			Balance_Load();
+			balance_counter = 0;
+		}
+	#endif
 }
 
 // Several steps with a cell upgrade call after each interval. Warning, I see no cell update function call! I have to fix it!
@@ -466,6 +578,186 @@ void Box::Translate(C2DVector d)
 	#endif
 }
 
+#ifdef LOAD_BALANCE
+// Like Translate, the particles are gathered by the root with the old cuts and sent to the nodes with the new ones.
+void Box::Balance_Load()
+{
+	if (thisnode->node_id == 0)
+		cout << "t = " << t << "\t";
+	vector<int> new_cut_x, new_cut_y;
+	if (!thisnode->Balance_Cuts(new_cut_x, new_cut_y))
+		return;
+
+	thisnode->Root_Gather();
+	thisnode->cut_x = new_cut_x;
+	thisnode->cut_y = new_cut_y;
+	thisnode->Init_Boundaries();
+	thisnode->Root_Bcast();
+	thisnode->Full_Update_Cells();
+	#ifdef verlet_list
+	thisnode->Update_Neighbor_List();
+	#endif
+}
+#endif
+
+#ifdef AUTO_TUNE
+// The state is restored, the box is divided with the candidate and tune_steps steps are timed. The largest speed of the particles in the run is returned in max_speed.
+Real Box::Tune_Candidate(int period, int input_divisor_x, int input_divisor_y, const vector<Particle>& initial_particle, const gsl_rng* initial_rng, Real initial_t, Real* max_speed)
+{
+	for (int i = 0; i < Ns; i++)
+		particle[i] = initial_particle[i];
+	gsl_rng_memcpy(C2DVector::gsl_r, initial_rng);
+	t = initial_t;
+	#ifdef PHILOX_RNG
+		Philox::step = tune_step;
+	#endif
+
+	cell_update_period = period;
+	thisnode->Resize_Cells(input_divisor_x, input_divisor_y);
+	#ifdef DISTRIBUTED_STORE
+		thisnode->Root_Bcast();
+	#endif
+	thisnode->Full_Update_Cells();
+	#ifdef verlet_list
+	thisnode->Update_Neighbor_List();
+	#endif
+
+	vector<C2DVector> r_before(Ns);
+	#ifdef DISTRIBUTED_STORE
+		for (int s = 0; s < thisnode->store.n; s++)
+		{
+			r_before[thisnode->store.id[s]].x = thisnode->store.x_original[s]; // Only the root has the particle objects
+			r_before[thisnode->store.id[s]].y = thisnode->store.y_original[s];
+		}
+	#else
+	for (int i = 0; i < Ns; i++)
+		r_before[i] = particle[i].r_original;
+	#endif
+
+	int steps = max(1, tune_steps / period)*period;
+	Real node_max_d2 = 0;
+	MPI_Barrier(node_comm);
+	double start_time = MPI_Wtime();
+	for (int k = 0; k < steps; k += period)
+	{
+		Multi_Step(period);
+// The particles of thisnode are up to date after Multi_Step, their displacement in the period gives the speed.
+		for (int x = thisnode->head_cell_idx; x < thisnode->tail_cell_idx; x++)
+			for (int y = thisnode->head_cell_idy; y < thisnode->tail_cell_idy; y++)
+				for (int j = 0; j < thisnode->cell[x][y].pid.size(); j++)
+				{
+					int i = thisnode->cell[x][y].pid[j];
+					#ifdef SPATIAL_REORDER
+						i = thisnode->store.id[i];
+					#endif
+					#ifdef DISTRIBUTED_STORE
+						C2DVector r_original;
+						r_original.x = thisnode->store.x_original[thisnode->cell[x][y].pid[j]];
+						r_original.y = thisnode->store.y_original[thisnode->cell[x][y].pid[j]];
+					#else
+						C2DVector r_original = particle[i].r_original;
+					#endif
+					C2DVector dr = r_original - r_before[i];
+					node_max_d2 = max(node_max_d2, dr.Square());
+					r_before[i] = r_original;
+				}
+	}
+	double node_time = (MPI_Wtime() - start_time) / steps;
+
+	double time_per_step;
+	MPI_Allreduce(&node_time, &time_per_step, 1, MPI_DOUBLE, MPI_MAX, node_comm);
+	Real max_d2;
+	MPI_Allreduce(&node_max_d2, &max_d2, 1, MPI_DOUBLE, MPI_MAX, node_comm);
+	*max_speed = sqrt(max_d2) / (period*dt);
+	return (time_per_step);
+}
+
+// The current division and period are safe by the worst case speed bound and they are timed first. The speed that is measured there, times tune_speed_factor, is the bound of the other candidates:
+// a period p needs cells not smaller than rv = interaction_range + 2*bound*p*dt, that is the condition of Cell::Cell(). For each period the smallest such cells and 1.5 and 2 times bigger cells are timed.
+// At the end the fastest candidate is kept and the state of the box is the same as before the call.
+void Box::Auto_Tune()
+{
+	thisnode->Root_Gather();
+	thisnode->Root_Bcast();
+	vector<Particle> initial_particle(particle, particle + Ns);
+	gsl_rng* initial_rng = gsl_rng_clone(C2DVector::gsl_r);
+	Real initial_t = t;
+	#ifdef PHILOX_RNG
+		tune_step = Philox::step;
+	#endif
+
+	Real measured_speed;
+	int best_period = cell_update_period;
+	int best_divisor_x = divisor_x;
+	int best_divisor_y = divisor_y;
+	Real best_rv = rv;
+	Real best_time = Tune_Candidate(cell_update_period, divisor_x, divisor_y, initial_particle, initial_rng, initial_t, &measured_speed);
+	if (thisnode->node_id == 0)
+		cout << "Auto tune: period " << best_period << " cells " << best_divisor_x << " by " << best_divisor_y << "\t" << best_time*1e3 << " ms/step (default), measured speed " << measured_speed << endl;
+
+	Real speed_bound = tune_speed_factor*((measured_speed > 0) ? measured_speed : speed);
+	const int period_num = 6;
+	int period_list[period_num] = {32, 64, 128, 256, 512, 1024};
+	const int factor_num = 3;
+	Real factor_list[factor_num] = {1, 1.5, 2};
+	for (int p = 0; p < period_num; p++)
+	{
+		Real candidate_rv = interaction_range + 2*speed_bound*period_list[p]*dt;
+		int last_divisor_x = -1;
+		for (int f = 0; f < factor_num; f++)
+		{
+			int candidate_divisor_x = (int) floor(Lx2 / (factor_list[f]*candidate_rv));
+			int candidate_divisor_y = (int) floor(Ly2 / (factor_list[f]*candidate_rv));
+// Each node needs at least two columns and two rows of cells, and three cells are needed so that a cell does not see itself through the periodic boundary.
+			if (candidate_divisor_x < max(3, 2*thisnode->npx) || candidate_divisor_y < max(3, 2*thisnode->npy))
+				continue;
+			if (candidate_divisor_x == last_divisor_x)
+				continue;
+			last_divisor_x = candidate_divisor_x;
+
+			rv = candidate_rv;
+			Real candidate_speed;
+			Real candidate_time = Tune_Candidate(period_list[p], candidate_divisor_x, candidate_divisor_y, initial_particle, initial_rng, initial_t, &candidate_speed);
+			if (thisnode->node_id == 0)
+				cout << "Auto tune: period " << period_list[p] << " cells " << candidate_divisor_x << " by " << candidate_divisor_y << "\t" << candidate_time*1e3 << " ms/step" << endl;
+			if (candidate_time < best_time)
+			{
+				best_time = candidate_time;
+				best_period = period_list[p];
+				best_divisor_x = candidate_divisor_x;
+				best_divisor_y = candidate_divisor_y;
+				best_rv = candidate_rv;
+			}
+		}
+	}
+
+// Going back to the initial state with the chosen cells
+	rv = best_rv;
+	lx_min = rv;
+	cell_update_period = best_period;
+	for (int i = 0; i < Ns; i++)
+		particle[i] = initial_particle[i];
+	gsl_rng_memcpy(C2DVector::gsl_r, initial_rng);
+	t = initial_t;
+	#ifdef PHILOX_RNG
+		Philox::step = tune_step;
+	#endif
+	thisnode->Resize_Cells(best_divisor_x, best_divisor_y);
+	#ifdef DISTRIBUTED_STORE
+		thisnode->Root_Bcast();
+	#endif
+	thisnode->Full_Update_Cells();
+	#ifdef verlet_list
+	thisnode->Update_Neighbor_List();
+	#endif
+	gsl_rng_free(initial_rng);
+
+	if (thisnode->node_id == 0)
+		cout << "Auto tune: chosen period " << cell_update_period << " and " << divisor_x << " by " << divisor_y << " cells (rv = " << rv << ", speed bound " << speed_bound << ") " << best_time*1e3 << " ms/step" << endl;
+	MPI_Barrier(node_comm);
+}
+#endif
+
 // Save polarization of the particles inside the box
 void Box::Save_Polarization(std::ostream& os)
 {
@@ -501,7 +793,8 @@ std::ostream& operator<<(std::ostream& os, Box* box)
 		}
 
 	}
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
+	return os;
 }
 
 // Reading the particle information (position and velocities) from a standard input stream (probably a file).
@@ -524,6 +817,100 @@ std::istream& operator>>(std::istream& is, Box* box)
 	{
 		box->particle[i].Read(is);
 	}
+	return is;
+}
+
+#ifdef MPIIO_OUTPUT
+void Box::Open_Frame_File(const string name, bool append)
+{
+	if (MPI_File_open(node_comm, (char*) name.c_str(), MPI_MODE_WRONLY | MPI_MODE_CREATE, MPI_INFO_NULL, &frame_file) != MPI_SUCCESS)
+	{
+		if (thisnode->node_id == 0)
+			cout << "Error, the trajectory file " << name << " can not be opened." << endl;
+		MPI_Abort(MPI_COMM_WORLD, 1390);
+	}
+	if (append)
+		MPI_File_get_size(frame_file, &frame_offset);
+	else
+	{
+		MPI_File_set_size(frame_file, 0);
+		frame_offset = 0;
+	}
 }
 
+// The frame has the layout of operator<<. The root writes the header and the membrane, and each node writes the records of the particles of its cells to their places in the frame, that are ordered by particle id.
+// The places are given to MPI by a file view, so all the records go in one collective write and the particles are not gathered by the root.
+void Box::Write_Frame()
+{
+// Every particle writes a record of the same size
+	stringstream record;
+	particle[Nm].Write(record);
+	int record_size = record.str().size();
+
+// The particle ids of thisnode in increasing order, as the displacements of a file view must be
+	vector<int> node_id_list;
+	for (int x = thisnode->head_cell_idx; x < thisnode->tail_cell_idx; x++)
+		for (int y = thisnode->head_cell_idy; y < thisnode->tail_cell_idy; y++)
+			for (int j = 0; j < thisnode->cell[x][y].pid.size(); j++)
+			{
+				int i = thisnode->cell[x][y].pid[j];
+				#ifdef SOA_STORE
+					thisnode->store.Export(particle, i); // Only the particles of thisnode are up to date in the store
+				#endif
+				#ifdef SPATIAL_REORDER
+					i = thisnode->store.id[i];
+				#endif
+				node_id_list.push_back(i);
+			}
+	sort(node_id_list.begin(), node_id_list.end());
+
+	stringstream records;
+	vector<int> displacement(node_id_list.size());
+	for (int k = 0; k < node_id_list.size(); k++)
+	{
+		particle[node_id_list[k]].Write(records);
+		displacement[k] = node_id_list[k] - Nm;
+	}
+	string buffer = records.str();
+
+	MPI_Offset header_size = 3*sizeof(Real) + 3*sizeof(int) + 2*Nm*sizeof(Saving_Real);
+	if (thisnode->node_id == 0)
+	{
+		stringstream header;
+		header.write((char*) &t, sizeof(Real) / sizeof(char));
+		header.write((char*) &(Lx), sizeof(Real) / sizeof(char));
+		header.write((char*) &(Ly), sizeof(Real) / sizeof(char));
+		header.write((char*) &(particle[Nm].nb), sizeof(int) / sizeof(char));
+		header.write((char*) &Ns, sizeof(Ns) / sizeof(char));
+		header.write((char*) &Nm, sizeof(Nm) / sizeof(char));
+		for (int i = 0; i < Nm; i++)
+			particle[i].r_original.write(header);
+		string header_buffer = header.str();
+		MPI_File_write_at(frame_file, frame_offset, (char*) header_buffer.data(), header_buffer.size(), MPI_BYTE, MPI_STATUS_IGNORE);
+	}
+
+// A node without particles still takes part in the collective write, with an empty buffer
+	MPI_Datatype record_type, node_type;
+	MPI_Type_contiguous(record_size, MPI_BYTE, &record_type);
+	if (displacement.size() > 0)
+		MPI_Type_create_indexed_block(displacement.size(), 1, &(displacement[0]), record_type, &node_type);
+	else
+		MPI_Type_dup(record_type, &node_type);
+	MPI_Type_commit(&node_type);
+
+	MPI_File_set_view(frame_file, frame_offset + header_size, MPI_BYTE, node_type, (char*) "native", MPI_INFO_NULL);
+	MPI_File_write_at_all(frame_file, 0, (char*) buffer.data(), buffer.size(), MPI_BYTE, MPI_STATUS_IGNORE);
+	MPI_File_set_view(frame_file, 0, MPI_BYTE, MPI_BYTE, (char*) "native", MPI_INFO_NULL);
+
+	MPI_Type_free(&node_type);
+	MPI_Type_free(&record_type);
+	frame_offset += header_size + (MPI_Offset) Ns*record_size;
+}
+
+void Box::Close_Frame_File()
+{
+	MPI_File_close(&frame_file);
+}
+#endif
+
 #endif
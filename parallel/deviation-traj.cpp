@@ -70,7 +70,7 @@ bool Init_Box(LyapunovBox& box, int argc, char *argv[])
 //		Single_Vortex_Formation(box.particle, box.N);
 		//	Four_Vortex_Formation(box.particle, box.N);
 	}
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 
 	MarkusParticle::kapa = input_kapa;
 	MarkusParticle::mu_plus = input_mu_plus;
@@ -93,9 +93,9 @@ bool Init_Box(LyapunovBox& box, int argc, char *argv[])
 	if (box.thisnode == 0)
 		cout << " Box information is: " << box.info.str() << endl;
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 	t_eq = equilibrium(box, equilibrium_step, saving_period);
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 
 	if (box.thisnode == 0)
 		cout << " Done in " << floor(t_eq / 60.0) << " minutes and " << t_eq - 60*floor(t_eq / 60.0) << " s" << endl;
@@ -159,13 +159,13 @@ bool Init_Box_From_File(LyapunovBox& box, const string input_name)
 
 	is.close();
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 
 	if (box.thisnode == 0)
 	{
 		cout << "number_of_particles = " << box.N << endl; // Printing number of particles.
 	}
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 
 	box.info.str("");
 	box.info << "rho=" << box.density <<  "-k=" << Particle::kapa << "-mu+=" << Particle::mu_plus << "-mu-=" << Particle::mu_minus << "-Dphi=" << Particle::D_phi << "-L=" << Lx;
@@ -178,12 +178,12 @@ Real Find_Traj(LyapunovBox& box, const Real& Dphi, const int& sample_num, const
 	Particle::D_phi = Dphi;
 	Particle::noise_amplitude = sqrt(2*Particle::D_phi) / sqrt(dt);
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 	equilibrium(box, equilibrium_step, saving_period);
 
 
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 }
 
 void Send_Trajectory(vector<Particle> send_traj, int N, int dest, int tag)
@@ -201,7 +201,7 @@ void Send_Trajectory(vector<Particle> send_traj, int N, int dest, int tag)
 		counter++;
 	}
 
-	MPI_Send(data_buffer, 3*send_traj.size(), MPI_DOUBLE, dest, 0,MPI_COMM_WORLD);
+	MPI_Send(data_buffer, 3*send_traj.size(), MPI_DOUBLE, dest, 0,node_comm);
 	delete [] data_buffer;
 }
 
@@ -211,7 +211,7 @@ void Recv_Traj(vector<Particle>& recv_traj, int N, int source, int tag)
 	double* data_buffer = new double[3*N];
 
 	MPI_Status status;
-	MPI_Recv(data_buffer, 3*N, MPI_DOUBLE, source, 0,MPI_COMM_WORLD, &status);
+	MPI_Recv(data_buffer, 3*N, MPI_DOUBLE, source, 0,node_comm, &status);
 
 // Assigning the buffer arrays
 	int counter = 0; // count particles. We can not use a shift very simply becasue we need to write both index_buffer and data_buffer.
@@ -277,7 +277,7 @@ void Run(int argc, char *argv[])
 		box.dvs = box.us;
 	}
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 
 	box.Root_Bcast_State_Hyper_Vector(box.vs.v[0]);
 	box.Root_Bcast_Vector_Set(box.dvs);
@@ -306,7 +306,7 @@ void Run(int argc, char *argv[])
 			Recv_Traj(trajectory[i], point_num, i % box.totalnode, i);
 	}
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 
 	if (box.thisnode == 0)
 	{
@@ -335,7 +335,7 @@ int main(int argc, char *argv[])
 
 	Run(argc, argv);
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 	MPI_Finalize();
 
 }
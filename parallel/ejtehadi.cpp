@@ -13,7 +13,7 @@ inline void timing_information(Node* node, clock_t start_time, int i_step, int t
 		int remaining_time = (lapsed_time*(total_step - i_step)) / (i_step + 1);
 		cout << "\r" << round(100.0*i_step / total_step) << "% lapsed time: " << lapsed_time << " s		remaining time: " << remaining_time << " s" << "\t P=" << node->polarization << flush;
 	}
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 }
 
 
@@ -161,15 +161,15 @@ void Run(Box& box, int argc, char *argv[])
 	if (box.thisnode->node_id == 0)
 		cout << " Box information is: " << box.info.str() << endl;
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 	t_eq = equilibrium(&box, equilibrium_step, saving_period, out_file);
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 
 	if (box.thisnode->node_id == 0)
 		cout << " Done in " << (t_eq / 60.0) << " minutes" << endl;
 
 	t_sim = data_gathering(&box, total_step, saving_period, out_file, polarization_file);
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 
 	if (box.thisnode->node_id == 0)
 	{
@@ -177,7 +177,7 @@ void Run(Box& box, int argc, char *argv[])
 		out_file.close();
 		polarization_file.close();
 	}
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 }
 
 
@@ -200,7 +200,7 @@ int main(int argc, char *argv[])
 
 	Run(box, argc, argv);
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 	MPI_Finalize();
 }
 
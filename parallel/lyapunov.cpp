@@ -15,7 +15,7 @@ inline void timing_information(Node* node, clock_t start_time, int i_step, int t
 		if (i_step % 1000 == 0)
 			cout << "\r" << round(100.0*i_step / total_step) << "% lapsed time: " << lapsed_time << " s		remaining time: " << remaining_time << " s" << flush;
 	}
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 }
 
 inline Real equilibrium(Box* box, long int equilibrium_step, int saving_period)
@@ -83,16 +83,16 @@ void Run(int argc, char *argv[], Node* thisnode)
 	if (thisnode->node_id == 0)
 		cout << " Box information is: " << box.info.str() << endl;
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 	t_eq = equilibrium(&box, equilibrium_step, saving_period);
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 
 	if (thisnode->node_id == 0)
 		cout << " Done in " << floor(t_eq / 60.0) << " minutes and " << t_eq - 60*floor(t_eq / 60.0) << " s" << endl;
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 	t_sim = box.Lyapunov_Exponent(10,100, 0.1, 100, 0.01, 20, 5);
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 
 	if (thisnode->node_id == 0)
 	{
@@ -101,7 +101,7 @@ void Run(int argc, char *argv[], Node* thisnode)
 		box.trajfile.close();
 	}
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 }
 
 bool Run_From_File(int argc, char *argv[], Node* thisnode)
@@ -128,9 +128,9 @@ bool Run_From_File(int argc, char *argv[], Node* thisnode)
 	if (thisnode->node_id == 0)
 		cout << " Box information is: " << box.info.str() << endl;
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
  	t_sim = box.Lyapunov_Exponent(1, 10, 0.1, 10, 3);
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 
 	if (thisnode->node_id == 0)
 	{
@@ -138,7 +138,7 @@ bool Run_From_File(int argc, char *argv[], Node* thisnode)
 		out_file.close();
 	}
 	
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 	return true;
 }
 
@@ -161,7 +161,7 @@ int main(int argc, char *argv[])
 	else
 		Run_From_File(argc, argv, &thisnode);
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 	MPI_Finalize();
 
 }
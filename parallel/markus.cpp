@@ -13,7 +13,7 @@ inline void timing_information(Node* node, clock_t start_time, int i_step, int t
 		int remaining_time = (lapsed_time*(total_step - i_step)) / (i_step + 1);
 		cout << "\r" << round(100.0*i_step / total_step) << "% lapsed time: " << lapsed_time << " s		remaining time: " << remaining_time << " s" << flush;
 	}
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 }
 
 inline Real equilibrium(Box* box, long int equilibrium_step, int saving_period, ofstream& out_file)
@@ -114,15 +114,15 @@ void Change_Noise(int argc, char *argv[], Node* thisnode)
 		if (thisnode->node_id == 0)
 			cout << " Box information is: " << box.info.str() << endl;
 
-		MPI_Barrier(MPI_COMM_WORLD);
+		MPI_Barrier(node_comm);
 		t_eq = equilibrium(&box, equilibrium_step, saving_period, out_file);
-		MPI_Barrier(MPI_COMM_WORLD);
+		MPI_Barrier(node_comm);
 
 		if (thisnode->node_id == 0)
 			cout << " Done in " << (t_eq / 60.0) << " minutes" << endl;
 
 		t_sim = data_gathering(&box, total_step, saving_period, out_file);
-		MPI_Barrier(MPI_COMM_WORLD);
+		MPI_Barrier(node_comm);
 
 		if (thisnode->node_id == 0)
 		{
@@ -130,7 +130,7 @@ void Change_Noise(int argc, char *argv[], Node* thisnode)
 			out_file.close();
 		}
 	}
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 }
 
 int main(int argc, char *argv[])
@@ -149,7 +149,7 @@ int main(int argc, char *argv[])
 
 	Change_Noise(argc, argv, &thisnode);
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 	MPI_Finalize();
 
 }
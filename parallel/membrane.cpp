@@ -15,7 +15,7 @@ inline void timing_information(Node* node, clock_t start_time, int i_step, int t
 		int remaining_time = (lapsed_time*(total_step - i_step)) / (i_step + 1);
 		cout << "\r" << round(100.0*i_step / total_step) << "% lapsed time: " << lapsed_time << " s		remaining time: " << remaining_time << " s" << flush;
 	}
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 }
 
 inline Real data_gathering(Box* box, long int total_step, int trajectory_saving_period, int quantities_saving_period, ofstream& out_file, ofstream& variables_file)
@@ -158,7 +158,7 @@ void Run(Box& box, int argc, char *argv[])
 
 		int quantities_saving_period = ( (int) round(16/dt) ) / cell_update_period;
 		t_sim = data_gathering(&box, total_step, saving_period, quantities_saving_period, out_file, variables_file);
-		MPI_Barrier(MPI_COMM_WORLD);
+		MPI_Barrier(node_comm);
 
 		if (box.thisnode->node_id == 0)
 		{
@@ -166,7 +166,7 @@ void Run(Box& box, int argc, char *argv[])
 			out_file.close();
 		}
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 }
 
 int main(int argc, char *argv[])
@@ -185,7 +185,7 @@ int main(int argc, char *argv[])
 
 	Run(box, argc, argv);
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 	MPI_Finalize();
 }
 
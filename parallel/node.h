@@ -3,11 +3,39 @@
 
 #include "boundary.h" // Any node has some boundaries with the neighboring nodes. Boundaries have information about adjasent nodes id and cells that are neighbor.
 
+#if defined(SPATIAL_REORDER) && !(defined(SOA_STORE) && defined(CELL_LIST_CSR))
+	#error "SPATIAL_REORDER needs SOA_STORE and CELL_LIST_CSR"
+#endif
+#if defined(VERLET_SKIN) && !defined(verlet_list)
+	#error "VERLET_SKIN needs verlet_list"
+#endif
+#if defined(AUTO_TUNE) && defined(VERLET_SKIN)
+	#error "AUTO_TUNE chooses the cell update period, but with VERLET_SKIN the cells are updated only when the list expires"
+#endif
+#if defined(BARRIER_FREE) && !defined(NONBLOCKING_HALO)
+	#error "BARRIER_FREE needs NONBLOCKING_HALO"
+#endif
+#if defined(PERSISTENT_HALO) && !defined(NONBLOCKING_HALO)
+	#error "PERSISTENT_HALO needs NONBLOCKING_HALO"
+#endif
+#if defined(NEIGHBOR_HALO) && defined(PERSISTENT_HALO)
+	#error "NEIGHBOR_HALO and PERSISTENT_HALO are two ways of the same exchange, only one of them can be used"
+#endif
+#if defined(DISTRIBUTED_STORE) && !defined(SPATIAL_REORDER)
+	#error "DISTRIBUTED_STORE needs SPATIAL_REORDER (and so SOA_STORE and CELL_LIST_CSR)"
+#endif
+#if defined(DISTRIBUTED_STORE) && defined(verlet_list)
+	#error "DISTRIBUTED_STORE works with the cells, the verlet list is indexed by the particle id"
+#endif
+#if defined(MIGRATION_UPDATE) && !defined(CELL_LIST_CSR)
+	#error "MIGRATION_UPDATE needs CELL_LIST_CSR"
+#endif
+
 struct Node{
 	int total_nodes; // total number of nodes
 	int node_id; // node_id is the id of thisnode.
 // Box is divided to reagions for our nodes. We lable the node position by idx and idy
-	int npx, npy; // For parallel use only. This number must be even to avoid dead locks
+	int npx, npy; // For parallel use only. This number must be even to avoid dead locks, except with NEIGHBOR_HALO where there is no ordering of the messages by parity
 	int idx,idy; // idx and idy shows the x position of the node inside the box
 	int size_x, size_y; // size_x and size_y is the column and row number of cells within thisnode. It might be different, because the number of columns in the box is not dividable to the number of node columns.
 // head_cell_idx is the idx of the first cell (the left most) in thisnode. The same for the head_cell_idy
@@ -23,6 +51,24 @@ struct Node{
 //Cell cell[divisor_x][divisor_y]; // We used cell list in our program. we divide the box to divisor_x by divisor_y cells. each cell has the information about particles id that are inside them.
 // Dynamic allocation
 	Cell** cell;
+	#ifdef SOA_STORE
+		Particle_Store store; // Structure of arrays copy of the particles. Cells, boundaries and walls work on the store and the particle objects are updated with Export_Store.
+	#endif
+	#ifdef CELL_LIST_CSR
+		Cell_List cell_list; // The particle ids of the cells of thisnode sorted by cell. The place of the cell of column x and row y is Cell_Key(x,y).
+	#endif
+	#ifdef VERLET_SKIN
+		Cell_List verlet; // Half neighbor list, the neighbors of particle i are verlet.index[verlet.offset[i]] ... verlet.index[verlet.offset[i+1]-1]
+		vector<Real> x_verlet, y_verlet; // Positions of the particles when the list was built
+	#endif
+	#ifdef LOAD_BALANCE
+		vector<int> cut_x, cut_y; // The cells of the node at (idx, idy) are cut_x[idx] <= x < cut_x[idx+1] and cut_y[idy] <= y < cut_y[idy+1]
+		double interaction_time; // Time of the interactions of thisnode since the last load balance
+	#endif
+	#ifdef SPATIAL_REORDER
+		int morton_side; // The smallest power of two that is not less than divisor_x and divisor_y
+		int update_counter; // number of cell updates since the last reordering
+	#endif
 
 // Summation of polarization of the node particles
 	C2DVector polarization_sum;
@@ -39,17 +85,71 @@ struct Node{
 	void Init_Rand(long int); // Initialize the random seed
 	void Find_npx_npy(); // Find the npx and npy, according to total number of nodes
 	void Find_npx_npy_Auto(); // Find the npx and npy automatically.
+	#ifdef CART_TOPOLOGY
+		void Find_npx_npy_Halo(); // Find the npx and npy with the fewest boundary cells and make the Cartesian communicator of the nodes
+	#endif
 	void Init_Topology();
+	void Init_Boundaries(); // Finding the cells of thisnode and its boundaries with the neighboring nodes
+	void Cell_Range(int input_node_id, int& head_x, int& tail_x, int& head_y, int& tail_y) const; // The cells of a node are head_x <= x < tail_x and head_y <= y < tail_y
+	#ifdef LOAD_BALANCE
+		void Even_Cuts(); // Cutting the columns and rows of cells evenly between the nodes
+		bool Balance_Cuts(vector<int>& new_cut_x, vector<int>& new_cut_y); // Finding the cuts that balance the load of the nodes, true if they must be moved. Init_Boundaries must be called after they are moved.
+		Real Imbalance(const vector<double>& load, const vector<int>& input_cut_x, const vector<int>& input_cut_y) const; // The largest load of a node over the average, load is the load of each cell
+	#endif
+	void Allocate_Cells(); // Allocating the cells of the box with the current divisor_x and divisor_y
+	#ifdef AUTO_TUNE
+		void Resize_Cells(int input_divisor_x, int input_divisor_y); // Dividing the box to a new number of cells
+	#endif
 	void Send_Receive_Data(); // Send and Receive data of each neighboring cell
+	#ifdef NONBLOCKING_HALO
+		vector<MPI_Request> halo_request; // requests of the exchange that is in flight, the receives come first
+		vector<int> halo_receiving; // the boundaries that wait for data
+		void Post_Halo(); // Starting the non-blocking exchange of the boundary data
+		void Wait_Halo(); // Completing the exchange and writing the received data to the boundary cells
+	#endif
+	#ifdef NEIGHBOR_HALO
+		MPI_Comm halo_comm; // The distributed graph of the boundaries, thisnode sends to the node of each active boundary and receives from the node of the opposite boundary
+		vector<int> halo_send_boundary, halo_receive_boundary; // The boundaries of the edges of the graph, in the order of the blocks of the buffers
+		vector<int> halo_send_count, halo_send_displacement, halo_receive_count, halo_receive_displacement;
+		vector<double> halo_send_buffer, halo_receive_buffer;
+		void Init_Halo_Graph(); // Making the graph of the boundaries, after the boundaries are found
+		void Pack_Halo(); // Writing the data of all this_cells to the send buffer and finding the block of each boundary
+		void Unpack_Halo(); // Reading the data of all that_cells from the receive buffer
+	#endif
+	void Check_Node_Size(); // Abort if the node structure counts some cells twice as neighbors
 	void Quick_Update_Cells(); // Update particles that are inside each cell
+	void Send_Receive_Particle_Ids(); // Send and Receive the particle ids of each neighboring cell
+	#ifdef MIGRATION_UPDATE
+		inline bool Migrating_Boundary(int i) const; // The boundary takes part in the exchange of the departures and arrivals, it is active and its cells are not the corner cells that an even boundary has too
+		void Send_Receive_Migration(const vector<Cell*>& new_cell); // Send and Receive the departures and arrivals of each neighboring cell
+	#endif
+	void Step_Barrier(); // The barrier between the moves and the interactions of a step, with BARRIER_FREE only the boundary messages synchronize the nodes
 	void Full_Update_Cells(); // Befor this function, Gather and Bcast must be called to have appropirate behaviour.
+	#ifdef CELL_LIST_CSR
+		void Build_Cell_List(const vector<int>& node_pid, const vector<int>& cell_id); // Sorting the particles by cell and pointing the pid of each cell to its part of the cell list
+		inline int Cell_Key(int x, int y) const; // The place of the cell of column x and row y in the cell list
+	#endif
+	#ifdef SPATIAL_REORDER
+		void Reorder_Store(); // Permuting the slots of the store to the order of the cell list
+	#endif
+	#ifdef DISTRIBUTED_STORE
+		inline bool In_Ghost_Ring(int x, int y, int head_x, int tail_x, int head_y, int tail_y) const; // The cell is inside the node of the range or in the ring of cells around it
+		void Compact_Store(); // Keeping only the particles of the cells of thisnode and of the boundary cells of the neighbors, in the order of the cell list
+		void Root_Scatter(); // Sending each node the particles of its cells and of the ghost ring from the root
+	#endif
 	void Update_Self_Neighbor_List(); // Updating neighborlist of particles inside cells within this node. But the pairs inside the node are considered
 	void Update_Boundary_Neighbor_List(); // Updating neighborlist of particles inside cells within this node. But one the particles is outside this node.
 	void Update_Neighbor_List(); // Updating neighborlist of particles inside cells within this node. All the pairs are considered.
+	#ifdef VERLET_SKIN
+		bool Verlet_Expired(); // True on all nodes if any particle has moved more than verlet_skin/2 since the list was built
+	#endif
 	void Send_To_Root(); // Send thisnode information (particle position and angles) to the root node.
 	void Root_Receive(); // Receive the sent information by other nodes
 	void Root_Gather(); // Gather the information by root. Like a Send_To_Root() and Root_Receive() function.
 	void Root_Bcast(); // Send all informations in root to other nodes
+	#ifdef SOA_STORE
+		void Export_Store(); // Copy the state of the particles of thisnode from the store to the particle array of the box.
+	#endif
 
 	void Neighbor_List_Interact(); // Interact using neighbor list
 	void Self_Interact(); // Compute interaction of particles withing thisnode
@@ -83,8 +183,8 @@ Node::Node()
 void Node::Init_Node()
 {
 // Get the information abount total nodes and thisnode id
-	MPI_Comm_size(MPI_COMM_WORLD, &total_nodes);
-	MPI_Comm_rank(MPI_COMM_WORLD, &node_id);
+	MPI_Comm_size(node_comm, &total_nodes);
+	MPI_Comm_rank(node_comm, &node_id);
 
 	#ifdef DEBUG
 		the_node_id = node_id;
@@ -96,6 +196,20 @@ void Node::Init_Node()
 	divisor_x = max_divisor_x;
 	divisor_y = max_divisor_y;
 
+	Allocate_Cells();
+
+	t = 0;
+	#ifdef NEIGHBOR_HALO
+		halo_comm = MPI_COMM_NULL;
+	#endif
+	#ifdef LOAD_BALANCE
+		interaction_time = 0;
+	#endif
+}
+
+// Allocating divisor_x by divisor_y cells and the cell list that is sized by them.
+void Node::Allocate_Cells()
+{
 	cell = new Cell*[divisor_x];
 	for (int i = 0; i < divisor_x; i++)
 		cell[i] = new Cell[divisor_y];
@@ -103,22 +217,74 @@ void Node::Init_Node()
 	for (int i = 0; i < divisor_x; i++)
 		for (int j = 0; j < divisor_y; j++)
 			cell[i][j].Init((Real) Lx*(2*i-divisor_x + 0.5)/divisor_x, (Real) Ly*(2*j-divisor_y + 0.5)/divisor_y); // setting the center position of each cell
+	#ifdef SPATIAL_REORDER
+		morton_side = 1;
+		while (morton_side < max(divisor_x, divisor_y))
+			morton_side *= 2;
+		update_counter = 0;
+		cell_list.Init(morton_side*morton_side);
+	#else
+	#ifdef CELL_LIST_CSR
+		cell_list.Init(divisor_x*divisor_y);
+	#endif
+	#endif
+}
 
-	t = 0;
+#ifdef AUTO_TUNE
+// The cells are freed and allocated again with the new division of the box and the boundaries are found for them. The particles must be put in the new cells by Full_Update_Cells.
+void Node::Resize_Cells(int input_divisor_x, int input_divisor_y)
+{
+	for (int i = 0; i < divisor_x; i++)
+		delete [] cell[i];
+	delete [] cell;
+
+	divisor_x = input_divisor_x;
+	divisor_y = input_divisor_y;
+	Allocate_Cells();
+	#ifdef LOAD_BALANCE
+		Even_Cuts();
+	#endif
+	Init_Boundaries();
 }
+#endif
 
 void Node::Get_Box_Info(int size, Particle* p)
 {
 	N = size;
 	particle = p;
 	Cell::particle = p; // Each cell has a pointer to partilce array of the box. The cell needs this pointer for sum of its actions.
+	#ifdef SOA_STORE
+		#ifdef DISTRIBUTED_STORE
+			store.Init(max(64, 2*N / total_nodes)); // The store grows if a node has more particles
+		#else
+		store.Init(N);
+		#endif
+		Cell::store = &store;
+	#endif
+	#ifdef VERLET_SKIN
+		verlet.Init(N);
+		x_verlet.resize(N);
+		y_verlet.resize(N);
+	#endif
+	#ifdef SIMD_KERNEL
+		const char* kernel_name = Select_Pair_Kernel();
+		if (node_id == 0)
+			cout << "Pair kernel: " << kernel_name << endl;
+	#endif
+	#ifdef TABULATED_FORCE
+		if (node_id == 0 && RepulsiveParticle::wall_table.n > 0)
+			RepulsiveParticle::wall_table.Report(cout);
+	#endif
 }
 
 void Node::Init_Rand(long int input_seed)
 {
 	seed = input_seed + node_id*112488;
 	C2DVector::Init_Rand(seed);
-	MPI_Barrier(MPI_COMM_WORLD);
+	#ifdef PHILOX_RNG
+		Philox::Init(input_seed); // The same key on all nodes
+	#endif
+	MPI_Barrier(node_comm);
 }
 
 void Node::Init_Rand()
@@ -127,9 +293,14 @@ void Node::Init_Rand()
 	while (!Chek_Seeds())
 	{
 		seed = time(NULL) + node_id*112488;
-		MPI_Barrier(MPI_COMM_WORLD);
+		MPI_Barrier(node_comm);
 	}
 	C2DVector::Init_Rand(seed);
+	#ifdef PHILOX_RNG
+		long int root_seed = seed;
+		MPI_Bcast(&root_seed, 1, MPI_LONG, 0, node_comm);
+		Philox::Init(root_seed); // The same key on all nodes
+	#endif
 }
 
 int ipow(int base, int exp)
@@ -207,6 +378,60 @@ void Node::Find_npx_npy_Auto()
 		cout << "The structure is:\n" << npx << "\t" << npy << endl;
 }
 
+#ifdef CART_TOPOLOGY
+// The number of cells that a node receives from its neighbors is 2*size_y for the left and right boundaries, 2*size_x for the top and bottom ones and 4 corners. The largest node of each grid counts, and a grid with a node narrower than two cells is not used (its cells would be counted twice as neighbors).
+void Node::Find_npx_npy_Halo()
+{
+	int best_halo = -1;
+	for (int temp_npx = 1; temp_npx <= total_nodes; temp_npx++)
+		if (total_nodes % temp_npx == 0)
+		{
+			int temp_npy = total_nodes / temp_npx;
+			if ((divisor_x / temp_npx < 2) || (divisor_y / temp_npy < 2))
+				continue;
+			int width_x = (divisor_x + temp_npx - 1) / temp_npx;
+			int width_y = (divisor_y + temp_npy - 1) / temp_npy;
+			int halo = 0;
+			if (temp_npx != 1)
+				halo += 2*width_y;
+			if (temp_npy != 1)
+				halo += 2*width_x;
+			if ((temp_npx != 1) && (temp_npy != 1))
+				halo += 4;
+			if ((best_halo == -1) || (halo < best_halo) || ((halo == best_halo) && (abs(temp_npx - temp_npy) < abs(npx - npy))))
+			{
+				best_halo = halo;
+				npx = temp_npx;
+				npy = temp_npy;
+			}
+		}
+	if (best_halo == -1)
+	{
+		if (node_id == 0)
+			cout << "Error, " << total_nodes << " nodes can not divide " << divisor_x << " by " << divisor_y << " cells with at least two columns and two rows of cells in each node." << endl;
+		MPI_Abort(MPI_COMM_WORLD, 1389);
+	}
+
+// The ranks of the grid are row major like node_id = idx*npy + idy, MPI may give them to the processes in another order to put the neighbors close to each other.
+	int dims[2] = {npx, npy};
+	#ifdef PERIODIC_BOUNDARY_CONDITION
+		int periods[2] = {1, 1};
+	#else
+		int periods[2] = {0, 0};
+	#endif
+	if (node_comm != MPI_COMM_WORLD)
+		MPI_Comm_free(&node_comm);
+	MPI_Cart_create(MPI_COMM_WORLD, 2, dims, periods, 1, &node_comm);
+	MPI_Comm_rank(node_comm, &node_id);
+	#ifdef DEBUG
+		the_node_id = node_id;
+	#endif
+
+	if (node_id == 0)
+		cout << "The structure is:\n" << npx << "\t" << npy << endl << "boundary cells per node: " << best_halo << endl;
+}
+#endif
+
 void Node::Find_npx_npy() // Find the npx and npy, according to total number of nodes
 {
 	switch(total_nodes){
@@ -342,44 +567,166 @@ void Node::Find_npx_npy() // Find the npx and npy, according to total number of
 
 void Node::Init_Topology() // This function must be called after box definition.
 {
+	#ifdef CART_TOPOLOGY
+		Find_npx_npy_Halo();
+	#else
 	Find_npx_npy_Auto();
+	#endif
+	#ifdef LOAD_BALANCE
+		Even_Cuts();
+	#endif
+	Init_Boundaries();
+}
 
+// The cells of any node, npx and npy must be known.
+void Node::Cell_Range(int input_node_id, int& head_x, int& tail_x, int& head_y, int& tail_y) const
+{
+	#ifdef LOAD_BALANCE
+		head_x = cut_x[input_node_id / npy];
+		tail_x = cut_x[input_node_id / npy + 1];
+		head_y = cut_y[input_node_id % npy];
+		tail_y = cut_y[input_node_id % npy + 1];
+	#else
 // Computing the typical column and row number of cells in each node
 	int width_x = divisor_x / npx;
 	int remain_x = divisor_x % npx;
 	int width_y = divisor_y / npy;
 	int remain_y = divisor_y % npy;
 
-// Finding the position of the node in the grid of nodes. First y index is increasing that means it changes faster than x index
-	idx = node_id / npy;
-	idy = node_id % npy;
+	int node_idx = input_node_id / npy;
+	int node_idy = input_node_id % npy;
 
 // The first nodes are slightly bigger (width + 1) to match the size of the system. Their number is the same as the reminder of cells in division
-	if (idx < remain_x)
-	{
-		head_cell_idx = idx*(width_x+1);
-		size_x = width_x+1;
-	}
+	if (node_idx < remain_x)
+		head_x = node_idx*(width_x+1);
 	else
-	{
-		head_cell_idx = remain_x + idx*width_x;
-		size_x = width_x;
-	}
+		head_x = remain_x + node_idx*width_x;
+	tail_x = head_x + ((node_idx < remain_x) ? (width_x+1) : width_x);
+
+	if (node_idy < remain_y)
+		head_y = node_idy*(width_y+1);
+	else
+		head_y = remain_y + node_idy*width_y;
+	tail_y = head_y + ((node_idy < remain_y) ? (width_y+1) : width_y);
+	#endif
+}
 
-	if (idy < remain_y)
+#ifdef LOAD_BALANCE
+// The same division as Cell_Range without LOAD_BALANCE, the first nodes have one more column (row) of cells.
+void Node::Even_Cuts()
+{
+	cut_x.resize(npx+1);
+	for (int i = 0; i <= npx; i++)
+		cut_x[i] = i*(divisor_x / npx) + min(i, divisor_x % npx);
+	cut_y.resize(npy+1);
+	for (int j = 0; j <= npy; j++)
+		cut_y[j] = j*(divisor_y / npy) + min(j, divisor_y % npy);
+}
+
+// The cut k of a line of cells is put where the summed load of the cells reaches k/parts of the total load. Each part keeps at least two cells (if there are enough), so no cell is the neighbor of a node from both sides.
+void Balance_Line(const vector<double>& load, int parts, vector<int>& cut)
+{
+	int n = load.size();
+	int min_width = max(1, min(2, n / parts));
+	vector<double> sum(n+1, 0); // sum[c] is the load of the cells before c
+	for (int c = 0; c < n; c++)
+		sum[c+1] = sum[c] + load[c];
+
+	cut.resize(parts+1);
+	cut[0] = 0;
+	cut[parts] = n;
+	int c = 0;
+	for (int k = 1; k < parts; k++)
 	{
-		head_cell_idy = idy*(width_y+1);
-		size_y = width_y+1;
+		double target = k*sum[n] / parts;
+		while (c < n && sum[c] < target)
+			c++;
+		int best = c;
+		if (c > 0 && (target - sum[c-1]) < (sum[c] - target))
+			best = c-1;
+		cut[k] = min(max(best, cut[k-1] + min_width), n - (parts-k)*min_width);
 	}
-	else
+}
+
+Real Node::Imbalance(const vector<double>& load, const vector<int>& input_cut_x, const vector<int>& input_cut_y) const
+{
+	double total_load = 0, max_load = 0;
+	for (int i = 0; i < npx; i++)
+		for (int j = 0; j < npy; j++)
+		{
+			double node_load = 0;
+			for (int x = input_cut_x[i]; x < input_cut_x[i+1]; x++)
+				for (int y = input_cut_y[j]; y < input_cut_y[j+1]; y++)
+					node_load += load[x*divisor_y + y];
+			total_load += node_load;
+			max_load = max(max_load, node_load);
+		}
+	return ((total_load > 0) ? max_load*npx*npy / total_load : 1);
+}
+
+// The interaction time of each node is divided between its cells by their particle number, so the load of a cell is the time that its particles take. If a node has not measured any time yet the particle numbers are the load.
+// The columns are cut by the load of the columns and the rows by the load of the rows, all the nodes of a column (row) of nodes keep the same cuts, so the boundaries stay as they are.
+bool Node::Balance_Cuts(vector<int>& new_cut_x, vector<int>& new_cut_y)
+{
+	int node_particles = 0;
+	for (int x = head_cell_idx; x < tail_cell_idx; x++)
+		for (int y = head_cell_idy; y < tail_cell_idy; y++)
+			node_particles += cell[x][y].pid.size();
+	int timed = (interaction_time > 0) ? 1 : 0;
+	int all_timed;
+	MPI_Allreduce(&timed, &all_timed, 1, MPI_INT, MPI_MIN, node_comm);
+	double particle_load = (all_timed && node_particles > 0) ? interaction_time / node_particles : 1;
+
+	vector<double> node_load(divisor_x*divisor_y, 0), load(divisor_x*divisor_y);
+	for (int x = head_cell_idx; x < tail_cell_idx; x++)
+		for (int y = head_cell_idy; y < tail_cell_idy; y++)
+			node_load[x*divisor_y + y] = cell[x][y].pid.size()*particle_load;
+	MPI_Allreduce(&(node_load[0]), &(load[0]), load.size(), MPI_DOUBLE, MPI_SUM, node_comm);
+	interaction_time = 0;
+
+	vector<double> column_load(divisor_x, 0), row_load(divisor_y, 0);
+	for (int x = 0; x < divisor_x; x++)
+		for (int y = 0; y < divisor_y; y++)
+		{
+			column_load[x] += load[x*divisor_y + y];
+			row_load[y] += load[x*divisor_y + y];
+		}
+	Balance_Line(column_load, npx, new_cut_x);
+	Balance_Line(row_load, npy, new_cut_y);
+
+	Real imbalance = Imbalance(load, cut_x, cut_y);
+	Real new_imbalance = Imbalance(load, new_cut_x, new_cut_y);
+	bool move = (imbalance > balance_threshold) && (new_imbalance < imbalance) && ((new_cut_x != cut_x) || (new_cut_y != cut_y));
+	if (node_id == 0)
 	{
-		head_cell_idy = remain_y + idy*width_y;
-		size_y = width_y;
+		cout << "Load balance: imbalance " << imbalance << (all_timed ? " (interaction time)" : " (particle number)");
+		if (move)
+		{
+			cout << ", the cuts are moved, expected imbalance " << new_imbalance << "\tx cuts:";
+			for (int i = 0; i <= npx; i++)
+				cout << " " << new_cut_x[i];
+			cout << "\ty cuts:";
+			for (int j = 0; j <= npy; j++)
+				cout << " " << new_cut_y[j];
+		}
+		cout << endl;
 	}
+	return (move);
+}
+#endif
+
+// Dividing the cells between the nodes and making the boundaries. npx and npy must be known.
+void Node::Init_Boundaries()
+{
+	boundary.clear();
 
-// Finding the last cell idx and idy in the node
-	tail_cell_idx = head_cell_idx + size_x;
-	tail_cell_idy = head_cell_idy + size_y;
+// Finding the position of the node in the grid of nodes. First y index is increasing that means it changes faster than x index
+	idx = node_id / npy;
+	idy = node_id % npy;
+
+	Cell_Range(node_id, head_cell_idx, tail_cell_idx, head_cell_idy, tail_cell_idy);
+	size_x = tail_cell_idx - head_cell_idx;
+	size_y = tail_cell_idy - head_cell_idy;
 
 	int list_of_node[npx][npy]; // We need id of the other nodes by giving their position on grid
 	for (int i = 0; i < npx; i++)
@@ -594,98 +941,228 @@ void Node::Init_Topology() // This function must be called after box definition.
 		boundary[3].is_active = false;
 		boundary[1].is_active = false;
 	}
+	#ifdef NEIGHBOR_HALO
+		Init_Halo_Graph();
+	#endif
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 // All nodes are ready
 }
 
+#ifdef NEIGHBOR_HALO
+// The edges are in the same order as the messages of Post_Halo: thisnode sends the blocks of boundaries i and receives the blocks of boundaries (i+4)%8 in the order of i. If two boundaries connect the same two nodes their blocks are matched in this order.
+void Node::Init_Halo_Graph()
+{
+	if (halo_comm != MPI_COMM_NULL)
+		MPI_Comm_free(&halo_comm);
+	halo_send_boundary.clear();
+	halo_receive_boundary.clear();
+	vector<int> destination, source;
+	for (int i = 0; i < boundary.size(); i++)
+		if (boundary[i].is_active)
+		{
+			halo_send_boundary.push_back(i);
+			destination.push_back(boundary[i].that_node_id);
+		}
+	for (int i = 0; i < boundary.size(); i++)
+		if (boundary[(i+4)%8].is_active)
+		{
+			halo_receive_boundary.push_back((i+4)%8);
+			source.push_back(boundary[(i+4)%8].that_node_id);
+		}
+	int no_node = 0; // a node without active boundaries gives a valid pointer with degree 0
+	MPI_Dist_graph_create_adjacent(node_comm, source.size(), source.empty() ? &no_node : &(source[0]), MPI_UNWEIGHTED, destination.size(), destination.empty() ? &no_node : &(destination[0]), MPI_UNWEIGHTED, MPI_INFO_NULL, 0, &halo_comm);
+
+	halo_send_count.resize(max((int) halo_send_boundary.size(), 1));
+	halo_send_displacement.resize(max((int) halo_send_boundary.size(), 1));
+	halo_receive_count.resize(max((int) halo_receive_boundary.size(), 1));
+	halo_receive_displacement.resize(max((int) halo_receive_boundary.size(), 1));
+}
+
+void Node::Pack_Halo()
+{
+	int data_size = 0;
+	for (int k = 0; k < halo_send_boundary.size(); k++)
+	{
+		halo_send_count[k] = boundary[halo_send_boundary[k]].Send_Size();
+		halo_send_displacement[k] = data_size;
+		data_size += halo_send_count[k];
+	}
+	if ((int) halo_send_buffer.size() < max(data_size, 1))
+		halo_send_buffer.resize(max(data_size, 1));
+	for (int k = 0; k < halo_send_boundary.size(); k++)
+		boundary[halo_send_boundary[k]].Pack_Data(&(halo_send_buffer[0]) + halo_send_displacement[k]);
+
+	data_size = 0;
+	for (int k = 0; k < halo_receive_boundary.size(); k++)
+	{
+		halo_receive_count[k] = boundary[halo_receive_boundary[k]].Receive_Size();
+		halo_receive_displacement[k] = data_size;
+		data_size += halo_receive_count[k];
+	}
+	if ((int) halo_receive_buffer.size() < max(data_size, 1))
+		halo_receive_buffer.resize(max(data_size, 1));
+}
+
+void Node::Unpack_Halo()
+{
+	for (int k = 0; k < halo_receive_boundary.size(); k++)
+		boundary[halo_receive_boundary[k]].Unpack_Data(&(halo_receive_buffer[0]) + halo_receive_displacement[k]);
+}
+#endif
+
 // Send_Receive_Data will update boundary cells of each node with its neighboring nodes
 // each node sends its information of boundary cells to the correspounding node.
 void Node::Send_Receive_Data()
 {
-	if (npx != 1)
-	{
-		for (int i = 0; i < boundary.size(); i++)
+	#ifdef NONBLOCKING_HALO
+		Post_Halo();
+		Wait_Halo();
+	#else
+	#ifdef NEIGHBOR_HALO
+		Pack_Halo();
+		MPI_Neighbor_alltoallv(&(halo_send_buffer[0]), &(halo_send_count[0]), &(halo_send_displacement[0]), MPI_DOUBLE, &(halo_receive_buffer[0]), &(halo_receive_count[0]), &(halo_receive_displacement[0]), MPI_DOUBLE, halo_comm);
+		Unpack_Halo();
+	#else
+		if (npx != 1)
 		{
-			if (i % 4 != 2)
+			for (int i = 0; i < boundary.size(); i++)
 			{
-				if (idx % 2 == 0)
+				if (i % 4 != 2)
 				{
-					if (boundary[i].is_active)
-						boundary[i].Send_Data(); // Send information of i'th boundary of thisnode to the neighboring node that shares this boundary.
-					if (boundary[(i+4)%8].is_active)
-						boundary[(i+4)%8].Receive_Data(); // Receive information of i'th boundary of neighboring node (if the neighbor exitst).
+					if (idx % 2 == 0)
+					{
+						if (boundary[i].is_active)
+							boundary[i].Send_Data(); // Send information of i'th boundary of thisnode to the neighboring node that shares this boundary.
+						if (boundary[(i+4)%8].is_active)
+							boundary[(i+4)%8].Receive_Data(); // Receive information of i'th boundary of neighboring node (if the neighbor exitst).
+					}
+					else
+					{
+						if (boundary[(i+4)%8].is_active)
+							boundary[(i+4)%8].Receive_Data(); // Receive information of i'th boundary of neighboring node.
+						if (boundary[i].is_active)
+							boundary[i].Send_Data(); // Send information of i'th boundary of thisnode to the neighboring node that shares this boundary (if there is any).
+					}
 				}
 				else
 				{
-					if (boundary[(i+4)%8].is_active)
-						boundary[(i+4)%8].Receive_Data(); // Receive information of i'th boundary of neighboring node.
-					if (boundary[i].is_active)
-						boundary[i].Send_Data(); // Send information of i'th boundary of thisnode to the neighboring node that shares this boundary (if there is any).
+					if (idy % 2 == 0)
+					{
+						if (boundary[i].is_active)
+							boundary[i].Send_Data(); // Send information of i'th boundary of thisnode to the neighboring node that shares this boundary (if there is any).
+						if (boundary[(i+4)%8].is_active)
+							boundary[(i+4)%8].Receive_Data(); // Receive information of i'th boundary of neighboring node (if the neighbor exitst).
+					}
+					else
+					{
+						if (boundary[(i+4)%8].is_active)
+							boundary[(i+4)%8].Receive_Data(); // Receive information of i'th boundary of neighboring node (if the neighbor exitst).
+						if (boundary[i].is_active)
+							boundary[i].Send_Data(); // Send information of i'th boundary of thisnode to the neighboring node that shares this boundary (if there is any).
+					}
 				}
+				MPI_Barrier(node_comm);
 			}
-			else
-			{
-				if (idy % 2 == 0)
-				{
-					if (boundary[i].is_active)
-						boundary[i].Send_Data(); // Send information of i'th boundary of thisnode to the neighboring node that shares this boundary (if there is any).
-					if (boundary[(i+4)%8].is_active)
-						boundary[(i+4)%8].Receive_Data(); // Receive information of i'th boundary of neighboring node (if the neighbor exitst).
-				}
-				else
-				{
-					if (boundary[(i+4)%8].is_active)
-						boundary[(i+4)%8].Receive_Data(); // Receive information of i'th boundary of neighboring node (if the neighbor exitst).
-					if (boundary[i].is_active)
-						boundary[i].Send_Data(); // Send information of i'th boundary of thisnode to the neighboring node that shares this boundary (if there is any).
-				}
-			}
-			MPI_Barrier(MPI_COMM_WORLD);
 		}
-	}
-	else
-	{
-		for (int i = 0; i < boundary.size(); i++)
+		else
 		{
-			if (i % 4 != 0)
-			{
-				if (idy % 2 == 0)
-				{
-					if (boundary[i].is_active)
-						boundary[i].Send_Data(); // Send information of i'th boundary of thisnode to the neighboring node that shares this boundary.
-					if (boundary[(i+4)%8].is_active)
-						boundary[(i+4)%8].Receive_Data(); // Receive information of i'th boundary of neighboring node (if the neighbor exitst).
-				}
-				else
-				{
-					if (boundary[(i+4)%8].is_active)
-						boundary[(i+4)%8].Receive_Data(); // Receive information of i'th boundary of neighboring node.
-					if (boundary[i].is_active)
-						boundary[i].Send_Data(); // Send information of i'th boundary of thisnode to the neighboring node that shares this boundary (if there is any).
-				}
-			}
-			else
+			for (int i = 0; i < boundary.size(); i++)
 			{
-				if (idx % 2 == 0)
+				if (i % 4 != 0)
 				{
-					if (boundary[i].is_active)
-						boundary[i].Send_Data(); // Send information of i'th boundary of thisnode to the neighboring node that shares this boundary (if there is any).
-					if (boundary[(i+4)%8].is_active)
-						boundary[(i+4)%8].Receive_Data(); // Receive information of i'th boundary of neighboring node (if the neighbor exitst).
+					if (idy % 2 == 0)
+					{
+						if (boundary[i].is_active)
+							boundary[i].Send_Data(); // Send information of i'th boundary of thisnode to the neighboring node that shares this boundary.
+						if (boundary[(i+4)%8].is_active)
+							boundary[(i+4)%8].Receive_Data(); // Receive information of i'th boundary of neighboring node (if the neighbor exitst).
+					}
+					else
+					{
+						if (boundary[(i+4)%8].is_active)
+							boundary[(i+4)%8].Receive_Data(); // Receive information of i'th boundary of neighboring node.
+						if (boundary[i].is_active)
+							boundary[i].Send_Data(); // Send information of i'th boundary of thisnode to the neighboring node that shares this boundary (if there is any).
+					}
 				}
 				else
 				{
-					if (boundary[(i+4)%8].is_active)
-						boundary[(i+4)%8].Receive_Data(); // Receive information of i'th boundary of neighboring node (if the neighbor exitst).
-					if (boundary[i].is_active)
-						boundary[i].Send_Data(); // Send information of i'th boundary of thisnode to the neighboring node that shares this boundary (if there is any).
+					if (idx % 2 == 0)
+					{
+						if (boundary[i].is_active)
+							boundary[i].Send_Data(); // Send information of i'th boundary of thisnode to the neighboring node that shares this boundary (if there is any).
+						if (boundary[(i+4)%8].is_active)
+							boundary[(i+4)%8].Receive_Data(); // Receive information of i'th boundary of neighboring node (if the neighbor exitst).
+					}
+					else
+					{
+						if (boundary[(i+4)%8].is_active)
+							boundary[(i+4)%8].Receive_Data(); // Receive information of i'th boundary of neighboring node (if the neighbor exitst).
+						if (boundary[i].is_active)
+							boundary[i].Send_Data(); // Send information of i'th boundary of thisnode to the neighboring node that shares this boundary (if there is any).
+					}
 				}
+				MPI_Barrier(node_comm);
 			}
-			MPI_Barrier(MPI_COMM_WORLD);
 		}
-	}
+	#endif
+	#endif
+	Check_Node_Size();
+}
 
+#ifdef NONBLOCKING_HALO
+// All the receives and sends are posted at once, so there is no ordering of the even and odd nodes and no barrier. Boundaries that connect the same two nodes have the same tag,
+// but the messages of one pair of nodes are not overtaking each other, and both nodes post them in the order of i: the send of boundary i of one node matches the receive of boundary (i+4)%8 of the other node.
+void Node::Post_Halo()
+{
+	#ifdef NEIGHBOR_HALO
+		Pack_Halo();
+		halo_request.resize(1);
+		MPI_Ineighbor_alltoallv(&(halo_send_buffer[0]), &(halo_send_count[0]), &(halo_send_displacement[0]), MPI_DOUBLE, &(halo_receive_buffer[0]), &(halo_receive_count[0]), &(halo_receive_displacement[0]), MPI_DOUBLE, halo_comm, &(halo_request[0]));
+		halo_receiving = halo_receive_boundary;
+	#else
+	halo_request.resize(2*boundary.size());
+	halo_receiving.clear();
+	int request_num = 0;
+	for (int i = 0; i < boundary.size(); i++)
+		if (boundary[(i+4)%8].is_active)
+		{
+			boundary[(i+4)%8].Post_Receive_Data(&(halo_request[request_num++]));
+			halo_receiving.push_back((i+4)%8);
+		}
+	for (int i = 0; i < boundary.size(); i++)
+		if (boundary[i].is_active)
+			boundary[i].Post_Send_Data(&(halo_request[request_num++]));
+	halo_request.resize(request_num);
+	#endif
+
+// A node that is its own neighbor (npx or npy is 1) receives to its own cells and resets their torques, so the exchange must be complete before any interaction.
+	bool self_neighbor = false;
+	for (int k = 0; k < halo_receiving.size(); k++)
+		self_neighbor = self_neighbor || (boundary[halo_receiving[k]].that_node_id == node_id);
+	if (self_neighbor)
+		Wait_Halo();
+}
+
+void Node::Wait_Halo()
+{
+	if (halo_request.size() > 0)
+		MPI_Waitall(halo_request.size(), &(halo_request[0]), MPI_STATUSES_IGNORE);
+	#ifdef NEIGHBOR_HALO
+		if (halo_receiving.size() > 0)
+			Unpack_Halo();
+	#else
+	for (int k = 0; k < halo_receiving.size(); k++)
+		boundary[halo_receiving[k]].Finish_Receive_Data();
+	#endif
+	halo_request.clear();
+	halo_receiving.clear();
+}
+#endif
+
+void Node::Check_Node_Size()
+{
 // Check if the structrue of nodes and their cells is not making trubble.
 
 	if (npx == 1 && npy == 2)
@@ -710,9 +1187,18 @@ void Node::Send_Receive_Data()
 void Node::Quick_Update_Cells()
 {
 	Send_Receive_Data();
-	MPI_Barrier(MPI_COMM_WORLD);
+	#ifndef BARRIER_FREE
+		MPI_Barrier(node_comm);
+	#endif
 
 	vector<int> node_pid; // pid is particle ids that possibly are within this node
+	#ifdef MIGRATION_UPDATE
+// The boundary cells are kept before they change, the neighbors send only what is different from them.
+		for (int i = 0; i < boundary.size(); i++)
+			if (Migrating_Boundary(i))
+				boundary[i].Save_Cell_Lists();
+		vector<Cell*> old_cell; // The cell of each particle of node_pid before the update
+	#endif
 
 // First we add particles in the neighboring cells which are not within the node. These particles may travell inside thisnode and we add them to the list of possible particles (node_pid). thisnode has a list of boundaries (right, top right, ...) and in the list of boundaries we have pointer to cells that belong to thisnode (this_cell) or to the neighobring node (that_cell). Here we only add that_cell particle ids because in future we will add all thisnode particles.
 	if ((npx != 1) && (npy != 1)) // Depending on the topology of the nodes, we might neglect the neighboring cells located at the corners (To avoid duplication). For the case when either of npx or npy are not equal to 1, then all the neighboring cells must be considered.
@@ -722,7 +1208,12 @@ void Node::Quick_Update_Cells()
 				for (int j = 0; j < boundary[i].that_cell.size(); j++)
 				{
 					for (int k = 0; k < boundary[i].that_cell[j]->pid.size(); k++)
+					{
 						node_pid.push_back(boundary[i].that_cell[j]->pid[k]);
+						#ifdef MIGRATION_UPDATE
+							old_cell.push_back(boundary[i].that_cell[j]);
+						#endif
+					}
 				}
 	}
 	else // Depending on the topology of the nodes, we might neglect the neighboring cells located at the corners (To avoid duplication). For the case when either of npx or npy are equal to 1, then each cell at the corners of one node are shared between two boundaries. For example the top right cell in that_node is also present in the right boundary cells of that_node. Nevertheless, considering only even boundaries (i+=2), solve the problem. That means we don't consider odd bounderies corresponding to duplicated cells at corners.
@@ -732,7 +1223,12 @@ void Node::Quick_Update_Cells()
 				for (int j = 0; j < boundary[i].that_cell.size(); j++)
 				{
 					for (int k = 0; k < boundary[i].that_cell[j]->pid.size(); k++)
+					{
 						node_pid.push_back(boundary[i].that_cell[j]->pid[k]);
+						#ifdef MIGRATION_UPDATE
+							old_cell.push_back(boundary[i].that_cell[j]);
+						#endif
+					}
 				}
 	}
 	for (int i = 0; i < boundary.size(); i++)
@@ -746,25 +1242,50 @@ void Node::Quick_Update_Cells()
 		for (int y = head_cell_idy; y < tail_cell_idy; y++)
 		{
 			for (int k = 0; k < cell[x][y].pid.size(); k++)
+			{
 				node_pid.push_back(cell[x][y].pid[k]);
+				#ifdef MIGRATION_UPDATE
+					old_cell.push_back(&cell[x][y]);
+				#endif
+			}
 			cell[x][y].Delete();
 		}
 
 // Here the program checks each particle in node_pid. If the particle position is in a cell which belongs to thisnode, the program will add them to the list. It is very important that information about particles of neighboring cells must be up to date. For example this function must be used after an interaction computation to make sure that recently such an update has been occured.
+	#ifdef CELL_LIST_CSR
+		vector<int> cell_id(node_pid.size()); // The cell of each particle in node_pid, the cells are filled at once by Build_Cell_List.
+	#endif
+	#ifdef MIGRATION_UPDATE
+		#ifdef DISTRIBUTED_STORE
+			vector<Cell*> new_cell(store.n, NULL); // The cell of each slot after the update
+		#else
+			vector<Cell*> new_cell(N, NULL); // The cell of each slot after the update
+		#endif
+	#endif
 	for (int i = 0; i < node_pid.size(); i++)
 	{
 // Find the index of the cell in which a particle are located.
 		int x,y;
-		x = (int) (particle[node_pid[i]].r.x + Lx)*divisor_x / Lx2;
-		y = (int) (particle[node_pid[i]].r.y + Ly)*divisor_y / Ly2;
+		#ifdef SOA_STORE
+			x = (int) (store.x[node_pid[i]] + Lx)*divisor_x / Lx2;
+			y = (int) (store.y[node_pid[i]] + Ly)*divisor_y / Ly2;
+		#else
+			x = (int) (particle[node_pid[i]].r.x + Lx)*divisor_x / Lx2;
+			y = (int) (particle[node_pid[i]].r.y + Ly)*divisor_y / Ly2;
+		#endif
 
 // Check if the particles are inside the box for a debug.
 		#ifdef DEBUG
 		if ((x >= divisor_x) || (x < 0) || (y >= divisor_y) || (y < 0))
 		{
 			cout << "\n Particle number " << node_pid[i] << " is Out of the box" << endl << flush;
-			cout << "Particle Position is " << particle[node_pid[i]].r << endl;
-			cout << "Particle  " << particle[node_pid[i]].v << endl;
+			#ifdef SOA_STORE
+				cout << "Particle Position is " << store.x[node_pid[i]] << "\t" << store.y[node_pid[i]] << endl;
+				cout << "Particle  " << store.vx[node_pid[i]] << "\t" << store.vy[node_pid[i]] << endl;
+			#else
+				cout << "Particle Position is " << particle[node_pid[i]].r << endl;
+				cout << "Particle  " << particle[node_pid[i]].v << endl;
+			#endif
 //			exit(0);
 			if (x == divisor_x)
 				x--;
@@ -785,103 +1306,271 @@ void Node::Quick_Update_Cells()
 //							cout << "Node: " << node_id << " Cell: " << x << " " << y << " " << particle[track].r << " " << particle[track].theta << endl << flush;
 		#endif
 		
-		cell[x % divisor_x][y % divisor_y].Add(node_pid[i]);
+		#ifdef CELL_LIST_CSR
+			cell_id[i] = Cell_Key(x % divisor_x, y % divisor_y);
+		#else
+			cell[x % divisor_x][y % divisor_y].Add(node_pid[i]);
+		#endif
+		#ifdef MIGRATION_UPDATE
+			new_cell[node_pid[i]] = &cell[x % divisor_x][y % divisor_y];
+		#endif
 	}
+	#ifdef MIGRATION_UPDATE
+// The particles that stayed in their cell go first in their old order and the ones that moved after them, so by the stable sort each cell is its old particles without the departures and then the arrivals.
+		vector<int> moved_pid, moved_cell_id;
+		int stayed = 0;
+		for (int i = 0; i < node_pid.size(); i++)
+			if (new_cell[node_pid[i]] == old_cell[i])
+			{
+				node_pid[stayed] = node_pid[i];
+				cell_id[stayed] = cell_id[i];
+				stayed++;
+			}
+			else
+			{
+				moved_pid.push_back(node_pid[i]);
+				moved_cell_id.push_back(cell_id[i]);
+			}
+		copy(moved_pid.begin(), moved_pid.end(), node_pid.begin() + stayed);
+		copy(moved_cell_id.begin(), moved_cell_id.end(), cell_id.begin() + stayed);
+	#endif
+	#ifdef CELL_LIST_CSR
+		Build_Cell_List(node_pid, cell_id);
+	#endif
 
 // We don't need node_pid anymore and we need it to be empty for our further use.
 	node_pid.clear();
 
 
 // Now particle indices are changed and we have to update information of boundaries. The particles of other nodes that are at boundaries
-	MPI_Barrier(MPI_COMM_WORLD);
+	#ifdef MIGRATION_UPDATE
+		Send_Receive_Migration(new_cell);
+	#else
+	#ifndef BARRIER_FREE
+		MPI_Barrier(node_comm);
+	#endif
+	Send_Receive_Particle_Ids();
+	#endif
 
-	if (npx != 1)
-	{
-		for (int i = 0; i < boundary.size(); i++)
+	#ifdef DISTRIBUTED_STORE
+// The particles that left the ghost ring are dropped at each update, and the new particles of thisnode (the ghosts that moved in) are put in their place in the cell order.
+		Compact_Store();
+	#else
+	#ifdef SPATIAL_REORDER
+		update_counter++;
+		if (update_counter >= reorder_period)
 		{
-			if (i % 4 != 2)
-			{
-				if (idx % 2 == 0)
-				{
-					if (boundary[i].is_active)
-						boundary[i].Send_Particle_Ids(); // Send information of i'th boundary of thisnode to the neighboring node that shares this boundary.
-					if (boundary[(i+4)%8].is_active)
-						boundary[(i+4)%8].Receive_Particle_Ids(); // Receive information of i'th boundary of neighboring node (if the neighbor exitst).
-				}
-				else
-				{
-					if (boundary[(i+4)%8].is_active)
-						boundary[(i+4)%8].Receive_Particle_Ids(); // Receive information of i'th boundary of neighboring node.
-					if (boundary[i].is_active)
-						boundary[i].Send_Particle_Ids(); // Send information of i'th boundary of thisnode to the neighboring node that shares this boundary (if there is any).
-				}
-			}
-			else
+			Reorder_Store();
+			update_counter = 0;
+		}
+	#endif
+	#endif
+
+	#ifndef BARRIER_FREE
+		MPI_Barrier(node_comm);
+	#endif
+}
+
+// The particle ids of this_cells are sent to the neighboring nodes and the ids of that_cells are received from them.
+void Node::Send_Receive_Particle_Ids()
+{
+	#if defined(NEIGHBOR_HALO)
+// Two exchanges on the graph of the boundaries, the particle number of each cell and then the ids.
+		int send_num = halo_send_boundary.size(), receive_num = halo_receive_boundary.size();
+		vector<int> size_send_count(max(send_num, 1)), size_send_displacement(max(send_num, 1)), index_send_count(max(send_num, 1)), index_send_displacement(max(send_num, 1));
+		int size_total = 0, index_total = 0;
+		for (int k = 0; k < send_num; k++)
+		{
+			Boundary* b = &boundary[halo_send_boundary[k]];
+			size_send_count[k] = b->this_cell.size();
+			size_send_displacement[k] = size_total;
+			size_total += size_send_count[k];
+			index_send_count[k] = 0;
+			for (int i = 0; i < b->this_cell.size(); i++)
+				index_send_count[k] += b->this_cell[i]->pid.size();
+			index_send_displacement[k] = index_total;
+			index_total += index_send_count[k];
+		}
+		vector<int> size_send(max(size_total, 1)), index_send(max(index_total, 1));
+		for (int k = 0; k < send_num; k++)
+			boundary[halo_send_boundary[k]].Pack_Particle_Ids(&(size_send[0]) + size_send_displacement[k], &(index_send[0]) + index_send_displacement[k]);
+
+		vector<int> size_receive_count(max(receive_num, 1)), size_receive_displacement(max(receive_num, 1)), index_receive_count(max(receive_num, 1)), index_receive_displacement(max(receive_num, 1));
+		size_total = 0;
+		for (int k = 0; k < receive_num; k++)
+		{
+			size_receive_count[k] = boundary[halo_receive_boundary[k]].that_cell.size();
+			size_receive_displacement[k] = size_total;
+			size_total += size_receive_count[k];
+		}
+		vector<int> size_receive(max(size_total, 1));
+		MPI_Neighbor_alltoallv(&(size_send[0]), &(size_send_count[0]), &(size_send_displacement[0]), MPI_INT, &(size_receive[0]), &(size_receive_count[0]), &(size_receive_displacement[0]), MPI_INT, halo_comm);
+
+		index_total = 0;
+		for (int k = 0; k < receive_num; k++)
+		{
+			index_receive_count[k] = 0;
+			for (int i = 0; i < size_receive_count[k]; i++)
+				index_receive_count[k] += size_receive[size_receive_displacement[k] + i];
+			index_receive_displacement[k] = index_total;
+			index_total += index_receive_count[k];
+		}
+		vector<int> index_receive(max(index_total, 1));
+		MPI_Neighbor_alltoallv(&(index_send[0]), &(index_send_count[0]), &(index_send_displacement[0]), MPI_INT, &(index_receive[0]), &(index_receive_count[0]), &(index_receive_displacement[0]), MPI_INT, halo_comm);
+
+		for (int k = 0; k < receive_num; k++)
+		{
+			Boundary* b = &boundary[halo_receive_boundary[k]];
+			#ifdef CELL_LIST_CSR
+				b->received_pid.assign(index_receive.begin() + index_receive_displacement[k], index_receive.begin() + index_receive_displacement[k] + index_receive_count[k]);
+				if (b->received_pid.size() == 0)
+					b->received_pid.push_back(0);
+				b->Unpack_Particle_Ids(&(size_receive[0]) + size_receive_displacement[k], &(b->received_pid[0]));
+			#else
+				b->Unpack_Particle_Ids(&(size_receive[0]) + size_receive_displacement[k], &(index_receive[0]) + index_receive_displacement[k]);
+			#endif
+		}
+	#elif defined(BARRIER_FREE)
+// The sizes are received first, after them the size of the ids is known. All the messages are posted in the order of i as in Post_Halo.
+		vector<MPI_Request> request(3*boundary.size());
+		vector<int> receiving;
+		int request_num = 0;
+		for (int i = 0; i < boundary.size(); i++)
+			if (boundary[(i+4)%8].is_active)
 			{
-				if (idy % 2 == 0)
-				{
-					if (boundary[i].is_active)
-						boundary[i].Send_Particle_Ids(); // Send information of i'th boundary of thisnode to the neighboring node that shares this boundary (if there is any).
-					if (boundary[(i+4)%8].is_active)
-						boundary[(i+4)%8].Receive_Particle_Ids(); // Receive information of i'th boundary of neighboring node (if the neighbor exitst).
-				}
-				else
-				{
-					if (boundary[(i+4)%8].is_active)
-						boundary[(i+4)%8].Receive_Particle_Ids(); // Receive information of i'th boundary of neighboring node (if the neighbor exitst).
-					if (boundary[i].is_active)
-						boundary[i].Send_Particle_Ids(); // Send information of i'th boundary of thisnode to the neighboring node that shares this boundary (if there is any).
-				}
+				boundary[(i+4)%8].Post_Receive_Cell_Size(&(request[request_num++]));
+				receiving.push_back((i+4)%8);
 			}
-			MPI_Barrier(MPI_COMM_WORLD);
-		}
-	}
-	else
-	{
+		int size_request_num = request_num;
 		for (int i = 0; i < boundary.size(); i++)
+			if (boundary[i].is_active)
+				boundary[i].Post_Send_Cell_Size(&(request[request_num++]));
+		for (int i = 0; i < boundary.size(); i++)
+			if (boundary[i].is_active)
+				boundary[i].Post_Send_Particle_Ids(&(request[request_num++]));
+		if (size_request_num > 0)
+			MPI_Waitall(size_request_num, &(request[0]), MPI_STATUSES_IGNORE);
+		for (int k = 0; k < receiving.size(); k++)
+			boundary[receiving[k]].Post_Receive_Particle_Ids(&(request[k]));
+		if (request_num > 0)
+			MPI_Waitall(request_num, &(request[0]), MPI_STATUSES_IGNORE);
+		for (int k = 0; k < receiving.size(); k++)
+			boundary[receiving[k]].Finish_Receive_Particle_Ids();
+	#else
+		if (npx != 1)
 		{
-			if (i % 4 != 0)
+			for (int i = 0; i < boundary.size(); i++)
 			{
-				if (idy % 2 == 0)
+				if (i % 4 != 2)
 				{
-					if (boundary[i].is_active)
-						boundary[i].Send_Particle_Ids(); // Send information of i'th boundary of thisnode to the neighboring node that shares this boundary.
-					if (boundary[(i+4)%8].is_active)
-						boundary[(i+4)%8].Receive_Particle_Ids(); // Receive information of i'th boundary of neighboring node (if the neighbor exitst).
+					if (idx % 2 == 0)
+					{
+						if (boundary[i].is_active)
+							boundary[i].Send_Particle_Ids(); // Send information of i'th boundary of thisnode to the neighboring node that shares this boundary.
+						if (boundary[(i+4)%8].is_active)
+							boundary[(i+4)%8].Receive_Particle_Ids(); // Receive information of i'th boundary of neighboring node (if the neighbor exitst).
+					}
+					else
+					{
+						if (boundary[(i+4)%8].is_active)
+							boundary[(i+4)%8].Receive_Particle_Ids(); // Receive information of i'th boundary of neighboring node.
+						if (boundary[i].is_active)
+							boundary[i].Send_Particle_Ids(); // Send information of i'th boundary of thisnode to the neighboring node that shares this boundary (if there is any).
+					}
 				}
 				else
 				{
-					if (boundary[(i+4)%8].is_active)
-						boundary[(i+4)%8].Receive_Particle_Ids(); // Receive information of i'th boundary of neighboring node.
-					if (boundary[i].is_active)
-						boundary[i].Send_Particle_Ids(); // Send information of i'th boundary of thisnode to the neighboring node that shares this boundary (if there is any).
+					if (idy % 2 == 0)
+					{
+						if (boundary[i].is_active)
+							boundary[i].Send_Particle_Ids(); // Send information of i'th boundary of thisnode to the neighboring node that shares this boundary (if there is any).
+						if (boundary[(i+4)%8].is_active)
+							boundary[(i+4)%8].Receive_Particle_Ids(); // Receive information of i'th boundary of neighboring node (if the neighbor exitst).
+					}
+					else
+					{
+						if (boundary[(i+4)%8].is_active)
+							boundary[(i+4)%8].Receive_Particle_Ids(); // Receive information of i'th boundary of neighboring node (if the neighbor exitst).
+						if (boundary[i].is_active)
+							boundary[i].Send_Particle_Ids(); // Send information of i'th boundary of thisnode to the neighboring node that shares this boundary (if there is any).
+					}
 				}
+				MPI_Barrier(node_comm);
 			}
-			else
+		}
+		else
+		{
+			for (int i = 0; i < boundary.size(); i++)
 			{
-				if (idx % 2 == 0)
+				if (i % 4 != 0)
 				{
-					if (boundary[i].is_active)
-						boundary[i].Send_Particle_Ids(); // Send information of i'th boundary of thisnode to the neighboring node that shares this boundary (if there is any).
-					if (boundary[(i+4)%8].is_active)
-						boundary[(i+4)%8].Receive_Particle_Ids(); // Receive information of i'th boundary of neighboring node (if the neighbor exitst).
+					if (idy % 2 == 0)
+					{
+						if (boundary[i].is_active)
+							boundary[i].Send_Particle_Ids(); // Send information of i'th boundary of thisnode to the neighboring node that shares this boundary.
+						if (boundary[(i+4)%8].is_active)
+							boundary[(i+4)%8].Receive_Particle_Ids(); // Receive information of i'th boundary of neighboring node (if the neighbor exitst).
+					}
+					else
+					{
+						if (boundary[(i+4)%8].is_active)
+							boundary[(i+4)%8].Receive_Particle_Ids(); // Receive information of i'th boundary of neighboring node.
+						if (boundary[i].is_active)
+							boundary[i].Send_Particle_Ids(); // Send information of i'th boundary of thisnode to the neighboring node that shares this boundary (if there is any).
+					}
 				}
 				else
 				{
-					if (boundary[(i+4)%8].is_active)
-						boundary[(i+4)%8].Receive_Particle_Ids(); // Receive information of i'th boundary of neighboring node (if the neighbor exitst).
-					if (boundary[i].is_active)
-						boundary[i].Send_Particle_Ids(); // Send information of i'th boundary of thisnode to the neighboring node that shares this boundary (if there is any).
+					if (idx % 2 == 0)
+					{
+						if (boundary[i].is_active)
+							boundary[i].Send_Particle_Ids(); // Send information of i'th boundary of thisnode to the neighboring node that shares this boundary (if there is any).
+						if (boundary[(i+4)%8].is_active)
+							boundary[(i+4)%8].Receive_Particle_Ids(); // Receive information of i'th boundary of neighboring node (if the neighbor exitst).
+					}
+					else
+					{
+						if (boundary[(i+4)%8].is_active)
+							boundary[(i+4)%8].Receive_Particle_Ids(); // Receive information of i'th boundary of neighboring node (if the neighbor exitst).
+						if (boundary[i].is_active)
+							boundary[i].Send_Particle_Ids(); // Send information of i'th boundary of thisnode to the neighboring node that shares this boundary (if there is any).
+					}
 				}
+				MPI_Barrier(node_comm);
 			}
-			MPI_Barrier(MPI_COMM_WORLD);
 		}
-	}
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	#endif
 }
 
 // Full_Update_Cells will update cells of each node (their particle) with the global information that means the master node will gather information of all other nodes and broadcast the whole information to every nodes. Therefor each node has the information of any other node and is aware of all particles. After we check all particles to see to which cell they belong.
+#ifdef MIGRATION_UPDATE
+inline bool Node::Migrating_Boundary(int i) const
+{
+	return (boundary[i].is_active && (((npx != 1) && (npy != 1)) || (i % 2 == 0)));
+}
+
+// The sends are posted at once in the order of i and the receives follow in the same order as in Post_Halo, a receive waits only for its own neighbor.
+void Node::Send_Receive_Migration(const vector<Cell*>& new_cell)
+{
+	vector<MPI_Request> request(boundary.size());
+	int request_num = 0;
+	for (int i = 0; i < boundary.size(); i++)
+		if (Migrating_Boundary(i))
+			boundary[i].Post_Send_Migration(new_cell, &(request[request_num++]));
+	for (int i = 0; i < boundary.size(); i++)
+		if (Migrating_Boundary((i+4)%8))
+			boundary[(i+4)%8].Receive_Migration();
+	if (request_num > 0)
+		MPI_Waitall(request_num, &(request[0]), MPI_STATUSES_IGNORE);
+
+// The odd boundaries that are left out share their cells with the even ones, their old buffer is not used anymore.
+	for (int i = 0; i < boundary.size(); i++)
+		if (boundary[i].is_active && !Migrating_Boundary(i))
+			boundary[i].received_pid.clear();
+}
+#endif
+
 void Node::Full_Update_Cells()
 {
 // First we need to empty the cells from our particle ids. (To avoid degeneracies!)
@@ -889,6 +1578,41 @@ void Node::Full_Update_Cells()
 		for (int y = 0; y < divisor_y; y++)
 			cell[x][y].Delete();
 
+	#ifdef DISTRIBUTED_STORE
+// The store has only the particles that Root_Scatter sent to thisnode, they are put in their cells from the store.
+		for (int i = 0; i < boundary.size(); i++)
+			boundary[i].received_pid.clear();
+		vector<int> node_pid(store.n), cell_id(store.n);
+		for (int s = 0; s < store.n; s++)
+		{
+			int x,y;
+			x = (int) (store.x[s] + Lx)*divisor_x / Lx2;
+			y = (int) (store.y[s] + Ly)*divisor_y / Ly2;
+			#ifdef DEBUG
+			if ((x >= divisor_x) || (x < 0) || (y >= divisor_y) || (y < 0))
+			{
+				cout << "\n Particle number " << store.id[s] << " is Out of the box" << endl << flush;
+				cout << "Particle Position is " << store.x[s] << "\t" << store.y[s] << endl;
+				exit(0);
+			}
+			#endif
+			node_pid[s] = s;
+			cell_id[s] = Cell_Key(x % divisor_x, y % divisor_y);
+		}
+		Build_Cell_List(node_pid, cell_id);
+		Compact_Store();
+		update_counter = 0;
+	#else
+
+// The particle objects are up to date (after a Bcast or a read), so the store is reloaded from them.
+	#ifdef SOA_STORE
+		for (int i = 0; i < N; i++)
+			store.Load(particle, i);
+	#endif
+
+	#ifdef CELL_LIST_CSR
+		vector<int> node_pid(N), cell_id(N);
+	#endif
 	for (int i = 0; i < N; i++)
 	{
 // Find the index of the cell in which a particle are located.
@@ -906,9 +1630,201 @@ void Node::Full_Update_Cells()
 		}
 		#endif
 
-		cell[x % divisor_x][y % divisor_y].Add(i);
+		#ifdef CELL_LIST_CSR
+			#ifdef SPATIAL_REORDER
+				node_pid[i] = store.slot[i];
+			#else
+				node_pid[i] = i;
+			#endif
+			cell_id[i] = Cell_Key(x % divisor_x, y % divisor_y);
+		#else
+			cell[x % divisor_x][y % divisor_y].Add(i);
+		#endif
+	}
+	#ifdef CELL_LIST_CSR
+		Build_Cell_List(node_pid, cell_id);
+	#endif
+	#ifdef SPATIAL_REORDER
+		Reorder_Store();
+		update_counter = 0;
+	#endif
+	#endif
+}
+
+#ifdef CELL_LIST_CSR
+inline int Node::Cell_Key(int x, int y) const
+{
+	#ifdef SPATIAL_REORDER
+// Morton (Z order) key: the bits of x and y are interleaved, so cells that are close in the box are mostly close in the list.
+		int key = 0;
+		for (int b = 0; (1 << b) < morton_side; b++)
+			key |= (((x >> b) & 1) << (2*b)) | (((y >> b) & 1) << (2*b+1));
+		return key;
+	#else
+		return x*divisor_y + y;
+	#endif
+}
+
+void Node::Build_Cell_List(const vector<int>& node_pid, const vector<int>& cell_id)
+{
+	if (node_pid.size() > 0)
+		cell_list.Build(&(node_pid[0]), &(cell_id[0]), node_pid.size());
+	else
+		cell_list.Build(NULL, NULL, 0);
+// Every cell points to its part of the list, cells without any particle here get an empty window. The pid of the cells of the neighboring nodes are replaced later by Receive_Particle_Ids.
+	for (int x = 0; x < divisor_x; x++)
+		for (int y = 0; y < divisor_y; y++)
+			cell[x][y].pid.Set(cell_list.Begin(Cell_Key(x,y)), cell_list.Size(Cell_Key(x,y)));
+}
+#endif
+
+#ifdef SPATIAL_REORDER
+// The particles of the cell list take the first slots in the order of the list (Morton order of their cells), the rest of the slots keep their order. Then the cell list and the received ids of the boundaries are renamed to the new slots.
+void Node::Reorder_Store()
+{
+	vector<int> new_order(N), new_slot(N, -1);
+	int k = 0;
+	for (int i = 0; i < cell_list.offset[cell_list.cell_num]; i++)
+		if (new_slot[cell_list.index[i]] == -1)
+		{
+			new_slot[cell_list.index[i]] = k;
+			new_order[k++] = cell_list.index[i];
+		}
+	for (int s = 0; s < N; s++)
+		if (new_slot[s] == -1)
+		{
+			new_slot[s] = k;
+			new_order[k++] = s;
+		}
+
+	store.Permute(&(new_order[0]));
+
+	for (int i = 0; i < cell_list.offset[cell_list.cell_num]; i++)
+		cell_list.index[i] = new_slot[cell_list.index[i]];
+	for (int i = 0; i < boundary.size(); i++)
+		if (boundary[i].is_active)
+			for (int j = 0; j < boundary[i].received_pid.size(); j++)
+				boundary[i].received_pid[j] = new_slot[boundary[i].received_pid[j]];
+}
+#endif
+
+#ifdef DISTRIBUTED_STORE
+inline bool Node::In_Ghost_Ring(int x, int y, int head_x, int tail_x, int head_y, int tail_y) const
+{
+	#ifdef PERIODIC_BOUNDARY_CONDITION
+		return ((((x - head_x + 1) % divisor_x + divisor_x) % divisor_x < tail_x - head_x + 2) && (((y - head_y + 1) % divisor_y + divisor_y) % divisor_y < tail_y - head_y + 2));
+	#else
+		return ((x >= head_x - 1) && (x <= tail_x) && (y >= head_y - 1) && (y <= tail_y));
+	#endif
+}
+
+// Like Reorder_Store, but the particles of the cells of thisnode come first in the order of the cell list, then the ghosts in the order of the boundary cells, and the rest of the slots are dropped.
+void Node::Compact_Store()
+{
+	int old_n = store.n;
+	vector<int> new_slot(old_n, -1), new_order;
+	new_order.reserve(old_n);
+
+	vector<char> own_key(cell_list.cell_num, 0);
+	for (int x = head_cell_idx; x < tail_cell_idx; x++)
+		for (int y = head_cell_idy; y < tail_cell_idy; y++)
+			own_key[Cell_Key(x,y)] = 1;
+	for (int c = 0; c < cell_list.cell_num; c++)
+		if (own_key[c])
+			for (int i = cell_list.offset[c]; i < cell_list.offset[c+1]; i++)
+				if (new_slot[cell_list.index[i]] == -1)
+				{
+					new_slot[cell_list.index[i]] = new_order.size();
+					new_order.push_back(cell_list.index[i]);
+				}
+	for (int i = 0; i < boundary.size(); i++)
+		if (boundary[i].is_active)
+			for (int j = 0; j < boundary[i].that_cell.size(); j++)
+				for (int k = 0; k < boundary[i].that_cell[j]->pid.size(); k++)
+				{
+					int s = boundary[i].that_cell[j]->pid[k];
+					if (new_slot[s] == -1)
+					{
+						new_slot[s] = new_order.size();
+						new_order.push_back(s);
+					}
+				}
+
+	store.Compact(new_order.size() > 0 ? &(new_order[0]) : NULL, new_order.size());
+
+// The dropped slots are -1, they are only in the cells that are out of the ghost ring and these cells are emptied.
+	for (int i = 0; i < cell_list.offset[cell_list.cell_num]; i++)
+		cell_list.index[i] = new_slot[cell_list.index[i]];
+	for (int i = 0; i < boundary.size(); i++)
+		if (boundary[i].is_active)
+			for (int j = 0; j < boundary[i].received_pid.size(); j++)
+			{
+				int s = boundary[i].received_pid[j];
+				boundary[i].received_pid[j] = (s >= 0 && s < old_n) ? new_slot[s] : -1;
+			}
+	for (int x = 0; x < divisor_x; x++)
+		for (int y = 0; y < divisor_y; y++)
+			if (!In_Ghost_Ring(x, y, head_cell_idx, tail_cell_idx, head_cell_idy, tail_cell_idy))
+				cell[x][y].pid.clear();
+}
+
+void Node::Root_Scatter()
+{
+	store.Compact(NULL, 0);
+	if (node_id == 0)
+	{
+		vector<int> particle_x(N), particle_y(N);
+		for (int i = 0; i < N; i++)
+		{
+			particle_x[i] = (int) (particle[i].r.x + Lx)*divisor_x / Lx2;
+			particle_y[i] = (int) (particle[i].r.y + Ly)*divisor_y / Ly2;
+		}
+		for (int k = 0; k < total_nodes; k++)
+		{
+			int head_x, tail_x, head_y, tail_y;
+			Cell_Range(k, head_x, tail_x, head_y, tail_y);
+			vector<int> index_buffer;
+			vector<double> data_buffer;
+			for (int i = 0; i < N; i++)
+				if (In_Ghost_Ring(particle_x[i], particle_y[i], head_x, tail_x, head_y, tail_y))
+				{
+					if (k == 0)
+						store.Load(particle, store.Add_Slot(i));
+					else
+					{
+						index_buffer.push_back(i);
+						data_buffer.push_back(particle[i].r.x);
+						data_buffer.push_back(particle[i].r.y);
+						data_buffer.push_back(particle[i].theta);
+						data_buffer.push_back(particle[i].r_original.x);
+						data_buffer.push_back(particle[i].r_original.y);
+					}
+				}
+			if (k != 0)
+			{
+				index_buffer.push_back(-1); // The buffers are never empty
+				data_buffer.resize(dof*index_buffer.size());
+				MPI_Send(&(index_buffer[0]), index_buffer.size(), MPI_INT, k, tag_max-1, node_comm);
+				MPI_Send(&(data_buffer[0]), data_buffer.size(), MPI_DOUBLE, k, tag_max, node_comm);
+			}
+		}
 	}
+	else
+	{
+		MPI_Status status;
+		int count;
+		MPI_Probe(0, tag_max-1, node_comm, &status);
+		MPI_Get_count(&status, MPI_INT, &count);
+		vector<int> index_buffer(count);
+		vector<double> data_buffer(dof*count);
+		MPI_Recv(&(index_buffer[0]), count, MPI_INT, 0, tag_max-1, node_comm, &status);
+		MPI_Recv(&(data_buffer[0]), dof*count, MPI_DOUBLE, 0, tag_max, node_comm, &status);
+		for (int j = 0; j < count-1; j++)
+			store.Load_Data(store.Add_Slot(index_buffer[j]), &(data_buffer[dof*j]));
+	}
+	MPI_Barrier(node_comm);
 }
+#endif
 
 // Using the information of particles we update a list for each particle showing the neighboring particles. But we are considering the third newton law. That means particles within the same node are counted once as neighbor in the neighbor list of one of the two particles.
 void Node::Update_Self_Neighbor_List()
@@ -1102,13 +2018,66 @@ void Node::Update_Boundary_Neighbor_List()
 // This function must be called after transfer of data between nodes.
 void Node::Update_Neighbor_List()
 {
+	#ifdef VERLET_SKIN
+		Cell::verlet_i.clear();
+		Cell::verlet_j.clear();
+	#else
 	for (int x = head_cell_idx; x < tail_cell_idx; x++)
 		for (int y = head_cell_idy; y < tail_cell_idy; y++)
 			cell[x][y].Clear_Neighbor_List();
+	#endif
 	Update_Self_Neighbor_List();
 	Update_Boundary_Neighbor_List();
+	#ifdef VERLET_SKIN
+// The pairs are sorted by their first particle (counting sort), and the positions are saved for Verlet_Expired.
+		if (Cell::verlet_i.size() > 0)
+			verlet.Build(&(Cell::verlet_j[0]), &(Cell::verlet_i[0]), Cell::verlet_i.size());
+		else
+			verlet.Build(NULL, NULL, 0);
+		for (int x = head_cell_idx; x < tail_cell_idx; x++)
+			for (int y = head_cell_idy; y < tail_cell_idy; y++)
+				for (int k = 0; k < cell[x][y].pid.size(); k++)
+				{
+					int i = cell[x][y].pid[k];
+					#ifdef SOA_STORE
+						x_verlet[i] = store.x[i];
+						y_verlet[i] = store.y[i];
+					#else
+						x_verlet[i] = particle[i].r.x;
+						y_verlet[i] = particle[i].r.y;
+					#endif
+				}
+	#endif
 }
 
+#ifdef VERLET_SKIN
+bool Node::Verlet_Expired()
+{
+	Real max_d2 = 0;
+	for (int x = head_cell_idx; x < tail_cell_idx; x++)
+		for (int y = head_cell_idy; y < tail_cell_idy; y++)
+			for (int k = 0; k < cell[x][y].pid.size(); k++)
+			{
+				int i = cell[x][y].pid[k];
+				#ifdef SOA_STORE
+					Real dx = store.x[i] - x_verlet[i];
+					Real dy = store.y[i] - y_verlet[i];
+				#else
+					Real dx = particle[i].r.x - x_verlet[i];
+					Real dy = particle[i].r.y - y_verlet[i];
+				#endif
+				#ifdef PERIODIC_BOUNDARY_CONDITION
+					dx -= Lx2*floor(dx / Lx2 + 0.5);
+					dy -= Ly2*floor(dy / Ly2 + 0.5);
+				#endif
+				max_d2 = max(max_d2, dx*dx + dy*dy);
+			}
+	Real global_max_d2;
+	MPI_Allreduce(&max_d2, &global_max_d2, 1, MPI_DOUBLE, MPI_MAX, node_comm);
+	return (4*global_max_d2 > verlet_skin*verlet_skin);
+}
+#endif
+
 
 // Sending information to Master node
 void Node::Send_To_Root()
@@ -1132,8 +2101,20 @@ void Node::Send_To_Root()
 			{
 				for (int i = 0; i < cell[x][y].pid.size(); i++)
 				{
-					int index = cell[x][y].pid[i];
+					#ifdef SPATIAL_REORDER
+						int index = store.id[cell[x][y].pid[i]]; // The objects and the root know particles by id, not by slot
+					#else
+						int index = cell[x][y].pid[i];
+					#endif
 					index_buffer[counter] = index;
+					#ifdef DISTRIBUTED_STORE
+						int s = cell[x][y].pid[i];
+						data_buffer[dof*counter] = store.x[s];
+						data_buffer[dof*counter+1] = store.y[s];
+						data_buffer[dof*counter+2] = store.theta[s];
+						data_buffer[dof*counter+3] = store.x_original[s];
+						data_buffer[dof*counter+4] = store.y_original[s];
+					#else
 					data_buffer[dof*counter] = particle[index].r.x;
 					data_buffer[dof*counter+1] = particle[index].r.y;
 					data_buffer[dof*counter+2] = particle[index].theta;
@@ -1144,12 +2125,13 @@ void Node::Send_To_Root()
 					#ifdef ejtehadi
 						data_buffer[dof*counter+3] = particle[index].phi;
 					#endif
+					#endif
 					counter++;
 				}
 			}
 // tag_max is the maximum of the available tag value. tag_max-1 is for index and tag_max is for the data
-		MPI_Send(index_buffer, particle_count, MPI_INT, 0, tag_max-1,MPI_COMM_WORLD);
-		MPI_Send(data_buffer, dof*particle_count, MPI_DOUBLE, 0, tag_max,MPI_COMM_WORLD);
+		MPI_Send(index_buffer, particle_count, MPI_INT, 0, tag_max-1,node_comm);
+		MPI_Send(data_buffer, dof*particle_count, MPI_DOUBLE, 0, tag_max,node_comm);
 
 // Deallocation
 		delete [] index_buffer;
@@ -1169,10 +2151,10 @@ void Node::Root_Receive()
 		for (int i = 1; i < total_nodes; i++)
 		{
 			MPI_Status status;
-			MPI_Recv(index_buffer,N,MPI_INT,i,tag_max-1,MPI_COMM_WORLD,&status); // receiving the indices.
+			MPI_Recv(index_buffer,N,MPI_INT,i,tag_max-1,node_comm,&status); // receiving the indices.
 			MPI_Get_count(&status, MPI_INT, &count); // Finding the number of indices that masternode received form node i.
 			data_buffer = new double[dof*count]; // Initialize array with length 3*counts (3 double for each particle)
-			MPI_Recv(data_buffer,dof*count,MPI_DOUBLE,i,tag_max,MPI_COMM_WORLD,&status); // receiving the data
+			MPI_Recv(data_buffer,dof*count,MPI_DOUBLE,i,tag_max,node_comm,&status); // receiving the data
 // Update each particle in according to the data that is received.
 			for (int j = 0; j < count; j++)
 			{
@@ -1197,19 +2179,39 @@ void Node::Root_Receive()
 	}
 }
 
+#ifdef SOA_STORE
+// Only the particles of thisnode are exported. The other particles are updated by their own node and reach the other nodes by a gather and bcast.
+void Node::Export_Store()
+{
+	for (int x = head_cell_idx; x < tail_cell_idx; x++)
+		for (int y = head_cell_idy; y < tail_cell_idy; y++)
+			for (int i = 0; i < cell[x][y].pid.size(); i++)
+				store.Export(particle, cell[x][y].pid[i]);
+}
+#endif
+
 // With this fucntion master node will gather the information of particles of any other node. In processes like saving the trajectory this is requiered.
 void Node::Root_Gather()
 {
+	#ifdef DISTRIBUTED_STORE
+		if (node_id == 0)
+			Export_Store(); // The particle objects are updated only here, the other nodes send the data of their store.
+	#endif
 	// Any node (thisnode) except the master node, must send its information to root (master node).
 	Send_To_Root(); // Sending information to master node.
 	Root_Receive(); // Receiving information by master node
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 }
 
 // Bcast send the information of every particles from the master node to other nodes. Perhaps befor a Bcast we may call Gather to have the correct information of all particles.
 void Node::Root_Bcast()
 {
+	#ifdef DISTRIBUTED_STORE
+// Each node needs only the particles of its cells and of the ghost ring around them, the particle objects of the other nodes are not updated.
+		Root_Scatter();
+		return;
+	#endif
 	double* data_buffer = new double[dof*N]; // Data buffer, three times of particle number N (x,y and theta)
 // Master node collect partilces information into the data_buffer.
 	if (node_id == 0)
@@ -1229,7 +2231,7 @@ void Node::Root_Bcast()
 		}
 	}
 // Broad casting to all nodes. The root node is 0.
-	MPI_Bcast(data_buffer, dof*N, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+	MPI_Bcast(data_buffer, dof*N, MPI_DOUBLE, 0, node_comm);
 // Other nodes have to assign the received valuse to the particles. No index is needed because we sent the information of particles by their order.
 	if (node_id != 0)
 	{
@@ -1251,16 +2253,32 @@ void Node::Root_Bcast()
 		}
 	}
 	delete [] data_buffer;
-	MPI_Barrier(MPI_COMM_WORLD); // We want to make sure that all the nodes have the same information at the end (finished their task).
+	MPI_Barrier(node_comm); // We want to make sure that all the nodes have the same information at the end (finished their task).
 }
 
 // Interaction of all particles within thisnode
 void Node::Neighbor_List_Interact()
 {
+	#ifdef VERLET_SKIN
+// The flat list has the pairs of the particles of thisnode with their neighbors in thisnode and in the boundary cells.
+	for (int x = head_cell_idx; x < tail_cell_idx; x++)
+		for (int y = head_cell_idy; y < tail_cell_idy; y++)
+			for (int k = 0; k < cell[x][y].pid.size(); k++)
+			{
+				int i = cell[x][y].pid[k];
+				for (int n = verlet.offset[i]; n < verlet.offset[i+1]; n++)
+					#ifdef SOA_STORE
+						store.Interact(i, verlet.index[n]);
+					#else
+						particle[i].Interact(particle[verlet.index[n]]);
+					#endif
+			}
+	#else
 // Self interaction
 	for (int x = head_cell_idx; x < tail_cell_idx; x++)
 		for (int y = head_cell_idy; y < tail_cell_idy; y++)
 			cell[x][y].Interact();
+	#endif
 }
 
 // Interaction of all particles within thisnode
@@ -1459,6 +2477,9 @@ void Node::Move()
 		for (int y = head_cell_idy; y < tail_cell_idy; y++)
 				cell[x][y].Move();
 	t += dt;
+	#ifdef PHILOX_RNG
+		Philox::step++;
+	#endif
 }
 
 #ifdef RUNGE_KUTTA2
@@ -1476,6 +2497,9 @@ void Node::Move_Runge_Kutta2_2()
 	for (int x = head_cell_idx; x < tail_cell_idx; x++)
 		for (int y = head_cell_idy; y < tail_cell_idy; y++)
 				cell[x][y].Move_Runge_Kutta2_2();
+	#ifdef PHILOX_RNG
+		Philox::step++;
+	#endif
 }
 #endif
 
@@ -1510,9 +2534,19 @@ void Node::Move_Runge_Kutta4_4()
 	for (int x = head_cell_idx; x < tail_cell_idx; x++)
 		for (int y = head_cell_idy; y < tail_cell_idy; y++)
 				cell[x][y].Move_Runge_Kutta4_4();
+	#ifdef PHILOX_RNG
+		Philox::step++;
+	#endif
 }
 #endif
 
+void Node::Step_Barrier()
+{
+	#ifndef BARRIER_FREE
+		MPI_Barrier(node_comm);
+	#endif
+}
+
 bool Node::Chek_Seeds()
 {
 	long int s[total_nodes];
@@ -1523,12 +2557,12 @@ bool Node::Chek_Seeds()
 	{
 		s[0] = seed;
 		for (int i = 1; i < total_nodes; i++)
-			MPI_Recv(&s[i],1,MPI_LONG_INT,i,1,MPI_COMM_WORLD, &status);
+			MPI_Recv(&s[i],1,MPI_LONG_INT,i,1,node_comm, &status);
 	}
 	else
-		MPI_Send(&seed,1,MPI_LONG_INT,0,1,MPI_COMM_WORLD);
+		MPI_Send(&seed,1,MPI_LONG_INT,0,1,node_comm);
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 
 	if (node_id == 0)
 	{
@@ -1538,18 +2572,18 @@ bool Node::Chek_Seeds()
 				b = b && (s[i] != s[j]);
 		int_b = b;
 		for (int i = 1; i < total_nodes; i++)
-			MPI_Send(&int_b,1,MPI_INT,i,1,MPI_COMM_WORLD);
+			MPI_Send(&int_b,1,MPI_INT,i,1,node_comm);
 	}
 	else
 	{
-		MPI_Recv(&int_b,1,MPI_INT,0,1,MPI_COMM_WORLD, &status);
+		MPI_Recv(&int_b,1,MPI_INT,0,1,node_comm, &status);
 		if (int_b == 1)
 			b = true;
 		else
 			b = false;
 	}
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 
 	return (b);
 }
@@ -1576,8 +2610,8 @@ void Node::Root_Gather_Polarization_Sum()
 	double p_sum[2] = {0};
 	buffer_p[0] = polarization_sum.x;
 	buffer_p[1] = polarization_sum.y;
-	MPI_Reduce(&buffer_p, &p_sum, 2, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Reduce(&buffer_p, &p_sum, 2, MPI_DOUBLE, MPI_SUM, 0, node_comm);
+	MPI_Barrier(node_comm);
 	polarization_sum.x = p_sum[0];
 	polarization_sum.y = p_sum[1];
 }
@@ -13,7 +13,9 @@ inline void timing_information(Box* box, clock_t start_time, int i_step, int tot
 		int remaining_time = (lapsed_time*(total_step - i_step)) / (i_step + 1);
 		cout << "\r" << box->t << "\t" << round(100.0*box->t / sim_time) << "% lapsed time: " << lapsed_time << " s		remaining time: " << remaining_time << " s" << flush;
 	}
-	MPI_Barrier(MPI_COMM_WORLD);
+	#ifndef BARRIER_FREE
+		MPI_Barrier(node_comm);
+	#endif
 }
 
 bool does_file_exist(const char *fileName)
@@ -63,7 +65,11 @@ inline Real data_gathering(Box* box, long int total_step, int saving_period, ofs
 	int saving_time = 0;
 
 	if (box->t < dt)
+		#ifdef MPIIO_OUTPUT
+			box->Write_Frame();
+		#else
 			out_file << box;
+		#endif
 
 	int i = 0;
 	while (box->t < sim_time)
@@ -72,7 +78,11 @@ inline Real data_gathering(Box* box, long int total_step, int saving_period, ofs
 		i += cell_update_period;
 		if ((i / cell_update_period) % saving_period == 0)
 		{
+			#ifdef MPIIO_OUTPUT
+				box->Write_Frame();
+			#else
 			out_file << box;
+			#endif
 			timing_information(box,start_time,i,total_step);
 		}
 	}
@@ -137,16 +147,24 @@ void Single_Run(Box& box, int argc, char *argv[])
 	if (FROM_FILE)
 	{
 		box.Positioning_Particles(name);
+		#ifdef MPIIO_OUTPUT
+			box.Open_Frame_File(address.str(), true);
+		#else
 		if (box.thisnode->node_id == 0)
 			out_file.open(address.str().c_str(), ios::out | ios::app | ios::binary);
+		#endif
 	}
 	else
 	{
 		if (does_file_exist(address.str().c_str()))
 		{
 			box.Positioning_Particles(address.str());
+			#ifdef MPIIO_OUTPUT
+				box.Open_Frame_File(address.str(), true);
+			#else
 			if (box.thisnode->node_id == 0)
 				out_file.open(address.str().c_str(), ios::out | ios::app | ios::binary);
+			#endif
 		}
 		else
 		{
@@ -155,24 +173,36 @@ void Single_Run(Box& box, int argc, char *argv[])
 				Triangle_Lattice_Formation(box.particle,box.Ns,0);
 				for (int i = 0; i < box.Ns; i++)
 					box.particle[i].r_original = box.particle[i].r;
-				out_file.open(address.str().c_str());
+				#ifndef MPIIO_OUTPUT
+					out_file.open(address.str().c_str());
+				#endif
 			}
 			box.Sync();
+			#ifdef MPIIO_OUTPUT
+				box.Open_Frame_File(address.str(), false);
+			#endif
 		}
 	}
 
+	#ifdef AUTO_TUNE
+		box.Auto_Tune();
+	#endif
+
 	if (box.thisnode->node_id == 0)
 		cout << " Box information is: " << box.info.str() << endl;
 
 		t_sim = data_gathering(&box, total_step, saving_period, out_file);
-		MPI_Barrier(MPI_COMM_WORLD);
+		MPI_Barrier(node_comm);
 
 		if (box.thisnode->node_id == 0)
 		{
 			cout << " Done in " << (t_sim / 60.0) << " minutes" << endl;
 			out_file.close();
 		}
-	MPI_Barrier(MPI_COMM_WORLD);
+		#ifdef MPIIO_OUTPUT
+			box.Close_Frame_File();
+		#endif
+	MPI_Barrier(node_comm);
 }
 
 void Change_Noise(Box& box, int argc, char *argv[])
@@ -236,15 +266,15 @@ void Change_Noise(Box& box, int argc, char *argv[])
 		if (box.thisnode->node_id == 0)
 			cout << " Box information is: " << box.info.str() << endl;
 
-//		MPI_Barrier(MPI_COMM_WORLD);
+//		MPI_Barrier(node_comm);
 //		t_eq = equilibrium(&box, equilibrium_step, saving_period, out_file);
-//		MPI_Barrier(MPI_COMM_WORLD);
+//		MPI_Barrier(node_comm);
 
 //		if (box.thisnode->node_id == 0)
 //			cout << " Done in " << (t_eq / 60.0) << " minutes" << endl;
 
 		t_sim = data_gathering(&box, total_step, saving_period, out_file);
-		MPI_Barrier(MPI_COMM_WORLD);
+		MPI_Barrier(node_comm);
 
 		if (box.thisnode->node_id == 0)
 		{
@@ -252,7 +282,7 @@ void Change_Noise(Box& box, int argc, char *argv[])
 			out_file.close();
 		}
 	}
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 }
 
 int main(int argc, char *argv[])
@@ -280,7 +310,7 @@ int main(int argc, char *argv[])
 	//Change_Noise(box, argc, argv);
 	Single_Run(box, argc, argv);
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 	MPI_Finalize();
 }
 
@@ -70,7 +70,7 @@ bool Init_Box(LyapunovBox& box, int argc, char *argv[])
 //		Single_Vortex_Formation(box.particle, box.N);
 		//	Four_Vortex_Formation(box.particle, box.N);
 	}
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 
 	MarkusParticle::kapa = input_kapa;
 	MarkusParticle::mu_plus = input_mu_plus;
@@ -96,9 +96,9 @@ bool Init_Box(LyapunovBox& box, int argc, char *argv[])
 	if (box.thisnode == 0)
 		cout << " Box information is: " << box.info.str() << endl;
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 	t_eq = equilibrium(box, equilibrium_step, saving_period);
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 
 	if (box.thisnode == 0)
 		cout << " Done in " << floor(t_eq / 60.0) << " minutes and " << t_eq - 60*floor(t_eq / 60.0) << " s" << endl;
@@ -162,13 +162,13 @@ bool Init_Box_From_File(LyapunovBox& box, const string input_name)
 
 	is.close();
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 
 	if (box.thisnode == 0)
 	{
 		cout << "number_of_particles = " << box.N << endl; // Printing number of particles.
 	}
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 
 	box.info.str("");
 	box.info << "rho=" << box.density <<  "-k=" << Particle::kapa << "-mu+=" << Particle::mu_plus << "-mu-=" << Particle::mu_minus << "-Dphi=" << Particle::D_phi << "-L=" << Lx;
@@ -184,12 +184,12 @@ Real Average_Lyapunov(LyapunovBox& box, const Real& Dphi, int sample_num, Real&
 	Particle::noise_amplitude = sqrt(2*Particle::D_phi) / sqrt(dt);
 	for (int i = 0; i < sample_num; i++)
 	{
-		MPI_Barrier(MPI_COMM_WORLD);
+		MPI_Barrier(node_comm);
 		equilibrium(box, equilibrium_step, saving_period);
 //		lambda += box.Recursive_Lyapunov_Exponent(0.01,300, 0.01, 300, 4);
 		lambda += box.Simple_Lyapunov_Exponent(0.01,100, 0.1, 100, 3);
 		M += box.Polarization();
-		MPI_Barrier(MPI_COMM_WORLD);
+		MPI_Barrier(node_comm);
 	}
 	lambda /= sample_num;
 	M /= sample_num;
@@ -209,9 +209,9 @@ void Average_Lyapunov_Noise_Change(LyapunovBox& box, const Real Dphi_max, const
 	{
 		Particle::D_phi = Dphi[i];
 		Particle::noise_amplitude = sqrt(2*Particle::D_phi) / sqrt(dt);
-		MPI_Barrier(MPI_COMM_WORLD);
+		MPI_Barrier(node_comm);
 		lambda[i] = Average_Lyapunov(box, Dphi[i], sample_num, M[i]);
-		MPI_Barrier(MPI_COMM_WORLD);
+		MPI_Barrier(node_comm);
 		if (box.thisnode == 0)
 			lambda_file << Dphi[i] << "\t" << lambda[i] << "\t" << M[i] << endl;
 	}
@@ -228,7 +228,7 @@ void Run(LyapunovBox& box, int argc, char *argv[])
 	Average_Lyapunov(box, Particle::D_phi, 1, M);
 //	Average_Lyapunov_Noise_Change(box, 0.6, 12, 10);
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 }
 
 bool Run_From_File(LyapunovBox& box, int argc, char *argv[])
@@ -254,9 +254,9 @@ bool Run_From_File(LyapunovBox& box, int argc, char *argv[])
 	if (box.thisnode == 0)
 		cout << " Box information is: " << box.info.str() << endl;
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
  	t_sim = box.Lyapunov_Exponent(1, 10, 0.1, 10, 3);
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 
 	if (box.thisnode == 0)
 	{
@@ -264,7 +264,7 @@ bool Run_From_File(LyapunovBox& box, int argc, char *argv[])
 		out_file.close();
 	}
 	
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 	return true;
 }
 
@@ -291,7 +291,7 @@ int main(int argc, char *argv[])
 	else
 		Run_From_File(box, argc, argv);
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 	MPI_Finalize();
 
 }
@@ -49,8 +49,8 @@ public:
 
 LyapunovBox::LyapunovBox() : Box()
 {
-	MPI_Comm_rank(MPI_COMM_WORLD, &thisnode);
-	MPI_Comm_size(MPI_COMM_WORLD, &totalnode);
+	MPI_Comm_rank(node_comm, &thisnode);
+	MPI_Comm_size(node_comm, &totalnode);
 }
 
 void LyapunovBox::Track_Particle(vector<Particle>& trajectory)
@@ -73,8 +73,11 @@ void LyapunovBox::Send_State_Hyper_Vector(const State_Hyper_Vector& shv, int des
 		counter++;
 	}
 
-	MPI_Send(data_buffer, 3*N, MPI_DOUBLE, dest, 0,MPI_COMM_WORLD);
-	MPI_Send(shv.gsl_r->state, shv.gsl_r->type->size, MPI_BYTE, dest, 0,MPI_COMM_WORLD);
+	MPI_Send(data_buffer, 3*N, MPI_DOUBLE, dest, 0,node_comm);
+	MPI_Send(shv.gsl_r->state, shv.gsl_r->type->size, MPI_BYTE, dest, 0,node_comm);
+	#ifdef PHILOX_RNG
+		MPI_Send((void*) &(shv.rng_step), sizeof(uint64_t), MPI_BYTE, dest, 0,node_comm);
+	#endif
 
 	delete [] data_buffer;
 }
@@ -85,7 +88,7 @@ void LyapunovBox::Recv_State_Hyper_Vector(const State_Hyper_Vector& shv, int sou
 	double* data_buffer = new double[3*N];
 
 	MPI_Status status;
-	MPI_Recv(data_buffer, 3*N, MPI_DOUBLE, source, 0,MPI_COMM_WORLD, &status);
+	MPI_Recv(data_buffer, 3*N, MPI_DOUBLE, source, 0,node_comm, &status);
 
 // Assigning the buffer arrays
 	int counter = 0; // count particles. We can not use a shift very simply becasue we need to write both index_buffer and data_buffer.
@@ -97,7 +100,10 @@ void LyapunovBox::Recv_State_Hyper_Vector(const State_Hyper_Vector& shv, int sou
 		counter++;
 	}
 
-	MPI_Recv(shv.gsl_r->state, shv.gsl_r->type->size, MPI_BYTE, source, 0,MPI_COMM_WORLD, &status);
+	MPI_Recv(shv.gsl_r->state, shv.gsl_r->type->size, MPI_BYTE, source, 0,node_comm, &status);
+	#ifdef PHILOX_RNG
+		MPI_Recv((void*) &(shv.rng_step), sizeof(uint64_t), MPI_BYTE, source, 0,node_comm, &status);
+	#endif
 
 	delete [] data_buffer;
 }
@@ -116,10 +122,13 @@ void LyapunovBox::Root_Bcast_State_Hyper_Vector(const State_Hyper_Vector& shv)
 			data_buffer[3*i+2] = shv.particle[i].theta;
 		}
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 
-	MPI_Bcast(data_buffer, 3*N, MPI_DOUBLE, 0, MPI_COMM_WORLD);
-	MPI_Bcast(shv.gsl_r->state, shv.gsl_r->type->size, MPI_BYTE, 0,MPI_COMM_WORLD);
+	MPI_Bcast(data_buffer, 3*N, MPI_DOUBLE, 0, node_comm);
+	MPI_Bcast(shv.gsl_r->state, shv.gsl_r->type->size, MPI_BYTE, 0,node_comm);
+	#ifdef PHILOX_RNG
+		MPI_Bcast((void*) &(shv.rng_step), sizeof(uint64_t), MPI_BYTE, 0,node_comm);
+	#endif
 
 	if (thisnode != 0)
 	{
@@ -133,7 +142,7 @@ void LyapunovBox::Root_Bcast_State_Hyper_Vector(const State_Hyper_Vector& shv)
 
 	delete [] data_buffer;
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 }
 
 
@@ -153,7 +162,7 @@ void LyapunovBox::Root_Gather_Vector_Set(const VectorSet& v)
 		}
 	}
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 }
 
 void LyapunovBox::Root_Bcast_Vector_Set(const VectorSet& v)
@@ -172,7 +181,7 @@ void LyapunovBox::Root_Bcast_Vector_Set(const VectorSet& v)
 		}
 	}
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 }
 
 
@@ -237,7 +246,7 @@ void LyapunovBox::Evolution_Reorthonormalize(bool save = false)
 		}
 	}
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 	Root_Bcast_Vector_Set(dvs);
 
 	Real tt = 0;
@@ -301,7 +310,7 @@ void LyapunovBox::Evolution_Reorthonormalize(bool save = false)
 	if (thisnode == 0)
 		Load(vs.v[0]);
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 }
 
 Real LyapunovBox::Recursive_Orthonormalize(Real interval, int iteration_num, bool save = false)
@@ -326,7 +335,7 @@ Real LyapunovBox::Recursive_Orthonormalize(Real interval, int iteration_num, boo
 	}
 
 // Broad casting the deviations
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 	Root_Bcast_State_Hyper_Vector(gamma0);
 
 	Real tt = 0;
@@ -345,7 +354,7 @@ Real LyapunovBox::Recursive_Orthonormalize(Real interval, int iteration_num, boo
 
 		vs.v[0] = gamma0;
 // Broad casting the deviations
-		MPI_Barrier(MPI_COMM_WORLD);
+		MPI_Barrier(node_comm);
 		Root_Bcast_Vector_Set(dvs);
 
 		for (int i = 0; i < us.direction_num; i++)
@@ -359,7 +368,7 @@ Real LyapunovBox::Recursive_Orthonormalize(Real interval, int iteration_num, boo
 			}
 		}
 
-		MPI_Barrier(MPI_COMM_WORLD);
+		MPI_Barrier(node_comm);
 		Root_Gather_Vector_Set(vs);
 
 		if (thisnode == 0)
@@ -391,7 +400,7 @@ Real LyapunovBox::Recursive_Orthonormalize(Real interval, int iteration_num, boo
 	if (thisnode == 0)
 		Load(gamma0);
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 
 	return (lambda);
 }
@@ -419,10 +428,10 @@ Real LyapunovBox::Find_Growth(bool save = false)
 	}
 
 // Broad casting the deviations
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 	Root_Bcast_State_Hyper_Vector(gamma0);
 	Root_Bcast_Vector_Set(dvs);
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 
 	Real tt = 0;
 	vs.v[0] = gamma0;
@@ -448,7 +457,7 @@ Real LyapunovBox::Find_Growth(bool save = false)
 			}
 		}
 
-		MPI_Barrier(MPI_COMM_WORLD);
+		MPI_Barrier(node_comm);
 		Root_Gather_Vector_Set(vs);
 
 		if (thisnode == 0)
@@ -472,10 +481,10 @@ Real LyapunovBox::Find_Growth(bool save = false)
 
 			gamma0 = vs.v[0];
 		}
-		MPI_Barrier(MPI_COMM_WORLD);
+		MPI_Barrier(node_comm);
 		Root_Bcast_State_Hyper_Vector(gamma0);
 	}
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(node_comm);
 
 	return (lambda);
 }
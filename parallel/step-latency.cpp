@@ -0,0 +1,93 @@
+#include "../shared/parameters.h"
+#include "../shared/c2dvector.h"
+#include "../shared/particle.h"
+#include "../shared/cell.h"
+#include "box.h"
+#include <vector>
+
+// Benchmark of the time of one step. Each node times its steps, at the end the times are reduced with MPI_MAX step by step, so the latency of a step is the time of the slowest node in that step.
+// Compile it once with and once without BARRIER_FREE (and NONBLOCKING_HALO) in parameters.h and run both with the same arguments and number of nodes:
+// mpirun -np 4 a.out L packing_fraction steps noise
+
+inline Real percentile(vector<double>& list, Real p)
+{
+	sort(list.begin(), list.end());
+	int i = (int) floor(p*(list.size() - 1));
+	return (list[i]);
+}
+
+int main(int argc, char *argv[])
+{
+	MPI_Init(&argc, &argv);
+
+	if (argc < 5)
+	{
+		cout << "arguments are: \n" << "L,\tpacking_fraction,\tsteps,\tnoise" << endl;
+		MPI_Finalize();
+		exit(0);
+	}
+	Real input_Lx = atof(argv[1]);
+	Real input_packing_fraction = atof(argv[2]);
+	int steps = atoi(argv[3]);
+	Real input_noise = atof(argv[4]);
+
+	Box box(input_Lx, input_Lx, input_packing_fraction);
+	Node thisnode;
+	thisnode.Init_Rand(seed);
+	box.thisnode = &thisnode;
+
+	Particle::Set_nb(1);
+	Particle::Set_F0(1);
+	Particle::Set_sigma_p(1);
+	Particle::Set_repulsion_radius(1.05);
+	Particle::Set_alignment_radius(1.1);
+	Particle::Set_A_p(20);
+	Particle::Set_g(1.0);
+
+	Real input_rho = 4*input_packing_fraction / (M_PI*Particle::sigma_p*Particle::sigma_p);
+	box.Init(&thisnode, input_rho);
+	Particle::Set_Dr(input_noise);
+
+	if (thisnode.node_id == 0)
+	{
+		Triangle_Lattice_Formation(box.particle,box.Ns,0);
+		for (int i = 0; i < box.Ns; i++)
+			box.particle[i].r_original = box.particle[i].r;
+	}
+	box.Sync();
+
+// Warming up
+	box.Multi_Step(cell_update_period);
+
+	vector<double> node_time(steps), step_time(steps);
+	for (int i = 0; i < steps; i++)
+	{
+		double start_time = MPI_Wtime();
+		box.One_Step();
+		if ((i+1) % cell_update_period == 0)
+		{
+			thisnode.Quick_Update_Cells();
+			#ifdef verlet_list
+				thisnode.Update_Neighbor_List();
+			#endif
+		}
+		node_time[i] = MPI_Wtime() - start_time;
+	}
+	MPI_Reduce(&(node_time[0]), &(step_time[0]), steps, MPI_DOUBLE, MPI_MAX, 0, node_comm);
+
+	if (thisnode.node_id == 0)
+	{
+		double sum = 0;
+		for (int i = 0; i < steps; i++)
+			sum += step_time[i];
+		#ifdef BARRIER_FREE
+			cout << "barrier free";
+		#else
+			cout << "with barriers";
+		#endif
+		cout << "\tnodes: " << thisnode.total_nodes << " (" << thisnode.npx << " by " << thisnode.npy << ")\tN: " << box.Ns << "\tsteps: " << steps << endl;
+		cout << "step latency (us)\tmean: " << 1e6*sum / steps << "\tmedian: " << 1e6*percentile(step_time, 0.5) << "\t99%: " << 1e6*percentile(step_time, 0.99) << "\tmax: " << 1e6*step_time[steps-1] << endl;
+	}
+
+	MPI_Finalize();
+}
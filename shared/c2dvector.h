@@ -7,6 +7,9 @@
 
 #include <gsl/gsl_rng.h>
 #include <gsl/gsl_randist.h>
+#ifdef PHILOX_RNG
+	#include "philox.h"
+#endif
 
 template<typename Type = Real>
 class Vec_template
@@ -0,0 +1,64 @@
+#ifndef _CELL_LIST_
+#define _CELL_LIST_
+
+#include "parameters.h"
+#include <vector>
+
+/*
+	Flat (CSR) cell list. The particle ids of all cells are kept in one contiguous array (index) sorted by cell, and the particles of cell c are index[offset[c]] ... index[offset[c+1]-1].
+	The list is built with a two pass counting sort: the first pass counts the particles of each cell, a prefix sum gives the offsets and the second pass scatters the ids to their place.
+	The sort is stable, so the particles of a cell have the same order as the input, the same order that push_back would give.
+*/
+
+class Cell_Particle_Ids{
+// The particle ids of one cell. It is a window to a Cell_List or to any other contiguous array of ids and has the part of the vector<int> interface that the loops use.
+public:
+	const int* data;
+	int n;
+
+	Cell_Particle_Ids() {data = NULL; n = 0;}
+	inline int size() const {return n;}
+	inline const int& operator[](int i) const {return data[i];}
+	inline void clear() {data = NULL; n = 0;}
+	inline void Set(const int* input_data, int input_n) {data = input_data; n = input_n;}
+};
+
+class Cell_List{
+public:
+	int cell_num; // number of cells
+	vector<int> offset; // offset[c] is the first element of cell c in index, offset[cell_num] is the number of particles
+	vector<int> index; // particle ids sorted by cell
+
+	Cell_List() {cell_num = 0;}
+
+	void Init(int input_cell_num);
+	void Build(const int* particle_id, const int* cell_id, int n); // particle_id[i] is in the cell cell_id[i]
+	inline int Size(int c) const {return offset[c+1] - offset[c];}
+	inline const int* Begin(int c) const {return &(index[0]) + offset[c];}
+};
+
+void Cell_List::Init(int input_cell_num)
+{
+	cell_num = input_cell_num;
+	offset.assign(cell_num+1, 0);
+}
+
+void Cell_List::Build(const int* particle_id, const int* cell_id, int n)
+{
+// First pass: counting the particles of each cell in offset[c+1]
+	offset.assign(cell_num+1, 0);
+	for (int i = 0; i < n; i++)
+		offset[cell_id[i]+1]++;
+
+// Prefix sum, offset[c] is the beginning of cell c
+	for (int c = 0; c < cell_num; c++)
+		offset[c+1] += offset[c];
+
+// Second pass: scattering the ids, fill is the next free place of each cell.
+	index.resize(n > 0 ? n : 1);
+	vector<int> fill(offset.begin(), offset.end() - 1);
+	for (int i = 0; i < n; i++)
+		index[fill[cell_id[i]]++] = particle_id[i];
+}
+
+#endif
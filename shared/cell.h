@@ -4,20 +4,41 @@
 #include "c2dvector.h"
 #include "parameters.h"
 #include <vector>
+#ifdef SOA_STORE
+	#include "particle-store.h"
+#endif
+#ifdef SIMD_KERNEL
+	#include "simd-kernel.h"
+#endif
+#if defined(CELL_LIST_CSR) || defined(VERLET_SKIN)
+	#include "cell-list.h"
+#endif
 
 class Cell{
 public:
-	vector<int> pid; // particle_id
+	#ifdef CELL_LIST_CSR
+		Cell_Particle_Ids pid; // particle_id, a window to the cell list of the node or to the received ids of a boundary
+	#else
+		vector<int> pid; // particle_id
+	#endif
 	C2DVector r; // Center position of the cell in the box
 	static C2DVector dim; // Dimension of the cell width and height
 	static Particle* particle; // This is a pointer to the original particle array pointer of the box. We need this pointer in some subroutins
+	#ifdef SOA_STORE
+		static Particle_Store* store; // Structure of arrays copy of the particles that is used in the interaction and move loops instead of particle.
+	#endif
+	#ifdef VERLET_SKIN
+		static vector<int> verlet_i, verlet_j; // The pairs that Neighbor_List finds, the node sorts them to a flat list.
+	#endif
 
 	Cell();
 
 	void Init();
 	void Init(Real x, Real y);
 	void Delete();
-	void Add(int p); // Add a particle id to the list of pid of this cell.
+	#ifndef CELL_LIST_CSR
+		void Add(int p); // Add a particle id to the list of pid of this cell.
+	#endif
 	void Clear_Neighbor_List(); // This will clean the neighbor list of particles inside this cell
 	void Neighbor_List(); // Adding neighboring particles to their list in a cell but each pair of close particles are presented only one time as a member of neighbor list of one of the pair particles.
 	void Neighbor_List(Cell* c); // Adding neighboring particles of different cells to the neighbor list of particles.
@@ -60,10 +81,12 @@ void Cell::Delete()
 	pid.clear();
 }
 
+#ifndef CELL_LIST_CSR
 void Cell::Add(int p)
 {
 	pid.push_back(p);
 }
+#endif
 
 void Cell::Clear_Neighbor_List()
 {
@@ -77,13 +100,26 @@ void Cell::Neighbor_List(Cell* c)
 	{
 		for (int j = 0; j < c->pid.size(); j++)
 		{
-			C2DVector dr = particle[pid[i]].r - particle[c->pid[j]].r;
+			#ifdef SOA_STORE
+				C2DVector dr;
+				dr.x = store->x[pid[i]] - store->x[c->pid[j]];
+				dr.y = store->y[pid[i]] - store->y[c->pid[j]];
+			#else
+				C2DVector dr = particle[pid[i]].r - particle[c->pid[j]].r;
+			#endif
 			#ifdef PERIODIC_BOUNDARY_CONDITION
 				dr.Periodic_Transform();
 			#endif
 			Real d = sqrt(dr.Square());
 			if (d < rv)
+				#ifdef VERLET_SKIN
+				{
+					verlet_i.push_back(pid[i]);
+					verlet_j.push_back(c->pid[j]);
+				}
+				#else
 				particle[pid[i]].neighbor_id.push_back(c->pid[j]);
+				#endif
 		}
 	}
 }
@@ -94,10 +130,23 @@ void Cell::Neighbor_List()
 	{
 		for (int j = i+1; j < pid.size(); j++)
 		{
-			C2DVector dr = particle[pid[i]].r - particle[pid[j]].r;
+			#ifdef SOA_STORE
+				C2DVector dr;
+				dr.x = store->x[pid[i]] - store->x[pid[j]];
+				dr.y = store->y[pid[i]] - store->y[pid[j]];
+			#else
+				C2DVector dr = particle[pid[i]].r - particle[pid[j]].r;
+			#endif
 			Real d = sqrt(dr.Square());
 			if (d < rv)
+				#ifdef VERLET_SKIN
+				{
+					verlet_i.push_back(pid[i]);
+					verlet_j.push_back(pid[j]);
+				}
+				#else
 				particle[pid[i]].neighbor_id.push_back(pid[j]);
+				#endif
 		}
 	}
 }
@@ -106,70 +155,132 @@ void Cell::Interact()
 {
 	for (int i = 0; i < pid.size(); i++)
 		for (int j = 0; j < particle[pid[i]].neighbor_id.size(); j++)
-			particle[pid[i]].Interact(particle[particle[pid[i]].neighbor_id[j]]);
+			#ifdef SOA_STORE
+				store->Interact(pid[i],particle[pid[i]].neighbor_id[j]);
+			#else
+				particle[pid[i]].Interact(particle[particle[pid[i]].neighbor_id[j]]);
+			#endif
 }
 
 void Cell::Interact(Cell* c)
 {
-	for (int i = 0; i < pid.size(); i++)
-	{
-		for (int j = 0; j < c->pid.size(); j++)
-			particle[pid[i]].Interact(particle[c->pid[j]]);
-	}
+	#ifdef SIMD_KERNEL
+		if ((pid.size() > 0) && (c->pid.size() > 0))
+			pair_kernel(store, &(pid[0]), pid.size(), &(c->pid[0]), c->pid.size(), false); // each particle with the whole cell c in lanes
+	#else
+		for (int i = 0; i < pid.size(); i++)
+		{
+			for (int j = 0; j < c->pid.size(); j++)
+				#ifdef SOA_STORE
+					store->Interact(pid[i],c->pid[j]);
+				#else
+					particle[pid[i]].Interact(particle[c->pid[j]]);
+				#endif
+		}
+	#endif
 }
 
 void Cell::Self_Interact()
 {
-	for (int i = 0; i < pid.size(); i++)
-	{
-		for (int j = i+1; j < pid.size(); j++)
-			particle[pid[i]].Interact(particle[pid[j]]);
-	}
+	#ifdef SIMD_KERNEL
+		if (pid.size() > 1)
+			pair_kernel(store, &(pid[0]), pid.size(), &(pid[0]), pid.size(), true); // each particle with the rest of the cell in lanes
+	#else
+		for (int i = 0; i < pid.size(); i++)
+		{
+			for (int j = i+1; j < pid.size(); j++)
+				#ifdef SOA_STORE
+					store->Interact(pid[i],pid[j]);
+				#else
+					particle[pid[i]].Interact(particle[pid[j]]);
+				#endif
+		}
+	#endif
 }
 
 void Cell::Move()
 {
+	#if defined(SOA_STORE) && defined(PHILOX_RNG)
+		if (pid.size() > 0)
+			store->Noise_Gen(&(pid[0]), pid.size());
+	#endif
 	for (int i = 0; i < pid.size(); i++)
-		particle[pid[i]].Move();
+		#ifdef SOA_STORE
+			store->Move(pid[i]);
+		#else
+			particle[pid[i]].Move();
+		#endif
 }
 
 #ifdef RUNGE_KUTTA2
 void Cell::Move_Runge_Kutta2_1()
 {
+	#if defined(SOA_STORE) && defined(PHILOX_RNG)
+		if (pid.size() > 0)
+			store->Noise_Gen(&(pid[0]), pid.size());
+	#endif
 	for (int i = 0; i < pid.size(); i++)
-		particle[pid[i]].Move_Runge_Kutta2_1();
+		#ifdef SOA_STORE
+			store->Move_Runge_Kutta2_1(pid[i]);
+		#else
+			particle[pid[i]].Move_Runge_Kutta2_1();
+		#endif
 }
 
 void Cell::Move_Runge_Kutta2_2()
 {
 	for (int i = 0; i < pid.size(); i++)
-		particle[pid[i]].Move_Runge_Kutta2_2();
+		#ifdef SOA_STORE
+			store->Move_Runge_Kutta2_2(pid[i]);
+		#else
+			particle[pid[i]].Move_Runge_Kutta2_2();
+		#endif
 }
 #endif
 
 #ifdef RUNGE_KUTTA4
 void Cell::Move_Runge_Kutta4_1()
 {
+	#if defined(SOA_STORE) && defined(PHILOX_RNG)
+		if (pid.size() > 0)
+			store->Noise_Gen(&(pid[0]), pid.size());
+	#endif
 	for (int i = 0; i < pid.size(); i++)
-		particle[pid[i]].Move_Runge_Kutta4_1();
+		#ifdef SOA_STORE
+			store->Move_Runge_Kutta4_1(pid[i]);
+		#else
+			particle[pid[i]].Move_Runge_Kutta4_1();
+		#endif
 }
 
 void Cell::Move_Runge_Kutta4_2()
 {
 	for (int i = 0; i < pid.size(); i++)
-		particle[pid[i]].Move_Runge_Kutta4_2();
+		#ifdef SOA_STORE
+			store->Move_Runge_Kutta4_2(pid[i]);
+		#else
+			particle[pid[i]].Move_Runge_Kutta4_2();
+		#endif
 }
 
 void Cell::Move_Runge_Kutta4_3()
 {
 	for (int i = 0; i < pid.size(); i++)
-		particle[pid[i]].Move_Runge_Kutta4_3();
+		#ifdef SOA_STORE
+			store->Move_Runge_Kutta4_3(pid[i]);
+		#else
+			particle[pid[i]].Move_Runge_Kutta4_3();
+		#endif
 }
 
 void Cell::Move_Runge_Kutta4_4()
 {
 	for (int i = 0; i < pid.size(); i++)
-		particle[pid[i]].Move_Runge_Kutta4_4();
+		#ifdef SOA_STORE
+			store->Move_Runge_Kutta4_4(pid[i]);
+		#else
+			particle[pid[i]].Move_Runge_Kutta4_4();
+		#endif
 }
 #endif
 
@@ -178,12 +289,26 @@ C2DVector Cell::Compute_Polarization_Sum()
 {
 	C2DVector vp_sum;
 	for (int i = 0; i < pid.size(); i++)
-		vp_sum += particle[pid[i]].v;
+	{
+		#ifdef SOA_STORE
+			vp_sum.x += store->vx[pid[i]];
+			vp_sum.y += store->vy[pid[i]];
+		#else
+			vp_sum += particle[pid[i]].v;
+		#endif
+	}
 	return vp_sum;
 }
 
 C2DVector Cell::dim;
 Particle* Cell::particle = NULL; // Be carefull that this pointer be initiated in future
+#ifdef SOA_STORE
+	Particle_Store* Cell::store = NULL; // It is initiated by the node
+#endif
+#ifdef VERLET_SKIN
+	vector<int> Cell::verlet_i;
+	vector<int> Cell::verlet_j;
+#endif
 
 #endif
 
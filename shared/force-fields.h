@@ -97,5 +97,125 @@ C2DVector Spring(const C2DVector& dr, const Real& d, const Real& sigma, const Re
 }
 
 
+/*
+	Force fields with the constants of the cutoff computed once, when the parameters are set, instead of once per pair.
+	The results are bit-for-bit the same as the functions above, the operations are done in the same order.
+*/
+
+template <int n> inline Real Integer_Power(const Real& x)
+{/*
+	x^n by squaring, for n = 13 it is (x^8*x^4)*x like the functions above.
+*/
+	return (n % 2) ? Integer_Power<n/2>(x*x)*x : Integer_Power<n/2>(x*x);
+}
+
+template <> inline Real Integer_Power<1>(const Real& x)
+{
+	return x;
+}
+
+template <> inline Real Integer_Power<0>(const Real& x)
+{
+	return 1;
+}
+
+template <int exponent> class Power_Repulsive_Truncated{
+/*
+	Truncated inverse power repulsion, f = amplitude*((sigma/d)^exponent - (sigma/cutoff)^exponent) along dr.
+	For exponent = 13 it is R12_Repulsive_Truncated.
+*/
+public:
+	Real cutoff, sigma, amplitude;
+	Real shift; // (sigma/cutoff)^exponent
+
+	Power_Repulsive_Truncated() {}
+	Power_Repulsive_Truncated(const Real& input_cutoff, const Real& input_sigma, const Real& input_amplitude) {Set(input_cutoff, input_sigma, input_amplitude);}
+
+	void Set(const Real& input_cutoff, const Real& input_sigma, const Real& input_amplitude)
+	{
+		cutoff = input_cutoff;
+		sigma = input_sigma;
+		amplitude = input_amplitude;
+		shift = Integer_Power<exponent>(sigma / cutoff);
+	}
+
+	inline C2DVector Force(const C2DVector& dr, const Real& d) const
+	{
+		Real strength = amplitude*(Integer_Power<exponent>(sigma / d) - shift);
+
+		C2DVector result;
+		result.x = strength*dr.x/d;
+		result.y = strength*dr.y/d;
+
+		return result;
+	}
+};
+
+typedef Power_Repulsive_Truncated<13> R12_Repulsive_Truncated_Field;
+
+class Yukawa_Truncated_Field{
+/*
+	The same as Yukawa_Truncated, the exponential at the cutoff is computed once in Set.
+*/
+public:
+	Real cutoff, sigma, amplitude;
+	Real shift; // exp(-cutoff/sigma)*(1/cutoff^2 + 1/(sigma*cutoff))
+
+	Yukawa_Truncated_Field() {}
+	Yukawa_Truncated_Field(const Real& input_cutoff, const Real& input_sigma, const Real& input_amplitude) {Set(input_cutoff, input_sigma, input_amplitude);}
+
+	void Set(const Real& input_cutoff, const Real& input_sigma, const Real& input_amplitude)
+	{
+		cutoff = input_cutoff;
+		sigma = input_sigma;
+		amplitude = input_amplitude;
+		Real cutoff2 = cutoff*cutoff;
+		shift = exp(- cutoff / sigma ) * ( 1. / cutoff2 + 1. / (sigma * cutoff));
+	}
+
+	inline Real Shape(const Real& d, const Real& d2) const // The force without the amplitude, d2 = d*d
+	{
+		return exp(- d / sigma ) * ( 1. / d2 + 1. / (sigma * d)) - shift;
+	}
+
+	inline C2DVector Force(const C2DVector& dr, const Real& d) const
+	{
+		Real d2 = d*d;
+
+		Real strength = amplitude * Shape(d, d2);
+
+		C2DVector result;
+		result.x = strength * dr.x /d;
+		result.y = strength * dr.y /d;
+		return result;
+	}
+};
+
+Real Alignment_Sin(const Real& theta, const Real& vx, const Real& vy, const Real& other_theta, const Real& other_vx, const Real& other_vy)
+{/*
+	"Sine of the angle between the heading of this particle and the other one", sin(other_theta - theta)
+	(vx,vy) = (cos(theta),sin(theta)) is the unit heading that every particle keeps updated with its theta. With TRIG_FREE_ALIGNMENT the sine is the cross product of the headings and no transcendental is computed per pair.
+	With COMPARE the cross product is checked against the sine of the angles.
+*/
+	#ifdef TRIG_FREE_ALIGNMENT
+		Real result = vx*other_vy - vy*other_vx;
+		#ifdef COMPARE
+			Real difference = result - sin(other_theta - theta);
+			if (difference > 1e-12 || difference < -1e-12)
+			{
+				cout << "Trig free alignment differs from the sine: " << setprecision(20) << theta << "\t" << other_theta << "\t" << difference << endl << flush;
+				exit(1);
+			}
+		#endif
+		return result;
+	#else
+		return sin(other_theta - theta);
+	#endif
+}
+
+Real Alignment_Sin(const Real& theta, const C2DVector& v, const Real& other_theta, const C2DVector& other_v)
+{
+	return Alignment_Sin(theta, v.x, v.y, other_theta, other_v.x, other_v.y);
+}
 
 #endif
@@ -0,0 +1,140 @@
+#ifndef _FORCE_TABLE_
+#define _FORCE_TABLE_
+
+#include "c2dvector.h"
+#include "parameters.h"
+#include "force-fields.h"
+#include <vector>
+
+/*
+	Tabulated force magnitudes. A function of the distance is sampled on a uniform grid in s = r^2 and interpolated with a natural cubic spline,
+	so a pair loop that already has d2 looks the force up without computing any transcendental.
+	The grid is refined (doubled) until the largest interpolation error, measured between the grid points, is below the error bound relative to the largest value in the table.
+	Below s_min (the steep core of the potentials) the table is not used and the exact function is called.
+	A function that is not smooth in r^2 at r = 0 (like the VicsekParticle2 sigmoid) is tabulated in r instead, the table does not care what its variable is.
+*/
+
+template <class Field> class Field_Magnitude{
+// Magnitude of the force of any force field of force-fields.h that has Force(dr,d), as a function of s = d^2
+public:
+	const Field* field;
+	Field_Magnitude(const Field& input_field) {field = &input_field;}
+	Real operator()(const Real& s) const
+	{
+		Real d = sqrt(s);
+		C2DVector dr;
+		dr.x = d;
+		dr.y = 0;
+		return field->Force(dr,d).x;
+	}
+};
+
+class Force_Table{
+public:
+	Real s_min, s_max; // the range of the variable (usually r^2) that is tabulated
+	Real ds, inverse_ds;
+	int n; // number of intervals
+	Real error_bound; // requested maximum error relative to the largest value
+	Real max_error; // the maximum error that is measured in the validation
+	Real max_value;
+	vector<Real> coefficient; // 4 coefficients per interval, v = ((c3*t + c2)*t + c1)*t + c0 with 0 <= t < 1
+
+	Force_Table() {n = 0;}
+	template <class Function> Force_Table(const Function& f, Real input_s_min, Real input_s_max, Real input_error_bound = 1e-9) {Build(f, input_s_min, input_s_max, input_error_bound);}
+
+	template <class Function> void Build(const Function& f, Real input_s_min, Real input_s_max, Real input_error_bound = 1e-9, int max_n = 1 << 16);
+	inline Real operator()(const Real& s) const;
+	void Report(std::ostream& os) const;
+
+private:
+	template <class Function> void Fit(const Function& f, int input_n);
+	template <class Function> Real Validate(const Function& f) const;
+};
+
+template <class Function> void Force_Table::Build(const Function& f, Real input_s_min, Real input_s_max, Real input_error_bound, int max_n)
+{
+	s_min = input_s_min;
+	s_max = input_s_max;
+	error_bound = input_error_bound;
+	int trial_n = 64;
+	Fit(f, trial_n);
+	max_error = Validate(f);
+	while (max_error > error_bound && 2*trial_n <= max_n)
+	{
+		trial_n *= 2;
+		Fit(f, trial_n);
+		max_error = Validate(f);
+	}
+	if (max_error > error_bound)
+		cout << "Warning: force table did not reach the error bound " << error_bound << " with " << n << " intervals, the error is " << max_error << endl;
+}
+
+template <class Function> void Force_Table::Fit(const Function& f, int input_n)
+{
+	n = input_n;
+	ds = (s_max - s_min) / n;
+	inverse_ds = 1.0 / ds;
+
+	vector<Real> y(n+1), m(n+1); // values and second derivatives (per unit t) at the grid points
+	max_value = 0;
+	for (int i = 0; i <= n; i++)
+	{
+		y[i] = f(s_min + i*ds);
+		max_value = max(max_value, (Real) fabs(y[i]));
+	}
+
+// Natural spline, m[0] = m[n] = 0, the tridiagonal system m[i-1] + 4 m[i] + m[i+1] = 6 (y[i+1] - 2 y[i] + y[i-1]) is solved with the Thomas algorithm
+	vector<Real> c_prime(n+1), d_prime(n+1);
+	m[0] = m[n] = 0;
+	c_prime[0] = 0;
+	d_prime[0] = 0;
+	for (int i = 1; i < n; i++)
+	{
+		Real rhs = 6*(y[i+1] - 2*y[i] + y[i-1]);
+		Real denominator = 4 - c_prime[i-1];
+		c_prime[i] = 1 / denominator;
+		d_prime[i] = (rhs - d_prime[i-1]) / denominator;
+	}
+	for (int i = n-1; i > 0; i--)
+		m[i] = d_prime[i] - c_prime[i]*m[i+1];
+
+	coefficient.resize(4*n);
+	for (int i = 0; i < n; i++)
+	{
+		coefficient[4*i] = y[i];
+		coefficient[4*i+1] = (y[i+1] - y[i]) - (2*m[i] + m[i+1]) / 6;
+		coefficient[4*i+2] = m[i] / 2;
+		coefficient[4*i+3] = (m[i+1] - m[i]) / 6;
+	}
+}
+
+template <class Function> Real Force_Table::Validate(const Function& f) const
+{
+	Real error = 0;
+	Real scale = (max_value > 0) ? max_value : 1;
+	for (int i = 0; i < n; i++)
+		for (int k = 1; k < 4; k++) // quarter, middle and three quarter points of each interval
+		{
+			Real s = s_min + (i + 0.25*k)*ds;
+			error = max(error, (Real) fabs((*this)(s) - f(s)) / scale);
+		}
+	return error;
+}
+
+inline Real Force_Table::operator()(const Real& s) const
+{
+	Real x = (s - s_min)*inverse_ds;
+	int i = (int) x;
+	if (i >= n)
+		i = n - 1;
+	Real t = x - i;
+	const Real* c = &(coefficient[4*i]);
+	return ((c[3]*t + c[2])*t + c[1])*t + c[0];
+}
+
+void Force_Table::Report(std::ostream& os) const
+{
+	os << "Force table: " << n << " intervals on [" << s_min << ", " << s_max << "), " << 4*n*sizeof(Real) << " bytes, max relative error " << max_error << " (bound " << error_bound << ")" << endl;
+}
+
+#endif
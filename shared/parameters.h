@@ -13,6 +13,42 @@
 //#define TRACK_PARTICLE
 // This will round torques to avoid any difference of this program and other versions caused by truncation of numbers (if we change order of a sum, the result will change because of the truncation error)
 //#define COMPARE
+// The parallel box keeps particles in a structure of arrays (shared/particle-store.h) that cells, nodes, boundaries and walls work on directly. Only for RepulsiveParticle.
+//#define SOA_STORE
+// Vectorized pair kernels (shared/simd-kernel.h) for the cell interactions, the kernel (AVX-512, AVX2 or scalar) is chosen at run time. Needs SOA_STORE.
+//#define SIMD_KERNEL
+// The alignment torque is computed from the cross product of the unit headings v that particles keep, instead of a sine per pair. With COMPARE it is checked against the sine.
+//#define TRIG_FREE_ALIGNMENT
+// The wall Yukawa force and the VicsekParticle2 sigmoid are looked up in cubic spline tables in r^2 (shared/force-table.h) instead of computing exp per contact.
+//#define TABULATED_FORCE
+// Cells keep a window to one flat cell list of the node (shared/cell-list.h) that is built by a counting sort, instead of a vector of particle ids per cell.
+//#define CELL_LIST_CSR
+// The slots of the particle store are sorted by the Morton key of their cell every reorder_period cell updates, so neighbors are close in memory. Needs SOA_STORE and CELL_LIST_CSR.
+//#define SPATIAL_REORDER
+// The Verlet list is one flat half neighbor list with a skin. It is rebuilt (with the cells) only when a particle has moved more than verlet_skin/2 since the last build. Needs verlet_list.
+//#define VERLET_SKIN
+// Box::Auto_Tune times a few hundred steps with several cell sizes and cell update periods at the start of a run and keeps the fastest safe pair. cell_update_period becomes a variable.
+//#define AUTO_TUNE
+// The noise of the dynamics is drawn from a counter based generator (shared/philox.h) keyed by the seed, the particle id and the step, so it does not depend on the order of the moves or the number of nodes.
+//#define PHILOX_RNG
+// The boundary data is exchanged with non-blocking sends and receives that are posted at once, without barriers, and the interactions inside a node are computed while the data is in flight.
+//#define NONBLOCKING_HALO
+// There is no global barrier in the steps and the cell updates, the nodes are synchronized only by the boundary messages. Collectives are left in the output and the reductions. Needs NONBLOCKING_HALO.
+//#define BARRIER_FREE
+// Each node keeps only its own particles and the ghosts of the neighboring boundary cells in its store, with the particle id as a field. Particles move between nodes through the ghost layer at Quick_Update_Cells, and the root scatters and gathers them. Needs SPATIAL_REORDER.
+//#define DISTRIBUTED_STORE
+// Quick_Update_Cells moves only the particles that changed their cell, and the nodes send each other only the departures and arrivals of the boundary cells, one message per boundary, instead of all the ids of the boundary cells. Needs CELL_LIST_CSR.
+//#define MIGRATION_UPDATE
+// The column and row cuts between the nodes are moved every balance_period cell updates so that the nodes have about the same interaction time (or particle number, before any time is measured). The imbalance is logged at each check.
+//#define LOAD_BALANCE
+// The grid of nodes (npx by npy) is the one with the fewest boundary cells per node for the real cell grid, with at least two columns and two rows of cells in each node. The nodes are the ranks of an MPI_Cart_create communicator that may reorder them to put neighbors on the same host.
+//#define CART_TOPOLOGY
+// The boundaries keep their data buffers and persistent requests (MPI_Send_init, MPI_Recv_init) for the exchange of the data, they are made again only when the particle number of the boundary cells changes at a cell update. Needs NONBLOCKING_HALO.
+//#define PERSISTENT_HALO
+// The boundary data and ids are exchanged by neighborhood collectives (MPI_Neighbor_alltoallv) on a distributed graph of the boundaries, instead of the sends and receives that are ordered by the parity of the nodes. With NONBLOCKING_HALO the non-blocking MPI_Ineighbor_alltoallv is used.
+//#define NEIGHBOR_HALO
+// The trajectory frames are written by all nodes to the shared file with MPI-IO (Box::Write_Frame), each node writes its own particles at their places in the frame, instead of a Root_Gather and a Root_Bcast before each frame. The file layout is the same.
+//#define MPIIO_OUTPUT
 
 #include <iostream>
 #include <iomanip>
@@ -33,6 +69,7 @@ class RepulsiveParticle;
 class ActiveBrownianChain;
 class RTPChain;
 class EjtehadiParticle;
+class Particle_Store;
 
 //#define ejtehadi
 
@@ -77,7 +114,11 @@ Real Ly2 = 2*Ly;
 Real dt = 1.0/1024/8;
 Real half_dt = dt/2;
 Real dt_over_6 = dt/6;
+#ifdef AUTO_TUNE
+int cell_update_period = 256; // It is chosen by Box::Auto_Tune
+#else
 const int cell_update_period = 256;
+#endif
 const int saving_period = 512;
 Real eq_time = 0;
 Real sim_time = 16384;  // 2^14 = 16384
@@ -88,13 +129,23 @@ const Real speed = 1;
 Real Dc = 0.5; // The noise above which the initial condition is disordered, and below it is polar ordered.
 const Real K = 0;
 
+#ifdef VERLET_SKIN
+Real verlet_cutoff = 1.1; // The largest interaction radius of the particles
+Real verlet_skin = 0.2; // The list keeps the pairs closer than verlet_cutoff + verlet_skin
+Real lx_min = verlet_cutoff + verlet_skin; // Cells must hold all the pairs of the list
+#else
 Real lx_min = (1 + 2*speed*cell_update_period*dt);
+#endif
 int max_divisor_x = static_cast<int> (Lx_int / lx_min);// must be smaller than Lx2*(1 - 2*cell_update_period*dt);
 int max_divisor_y = static_cast<int> (Ly_int / lx_min);// must be smaller than Ly2*(1 - 2*cell_update_period*dt);
 int divisor_x = max_divisor_x;
 int divisor_y = max_divisor_y;
 
+#ifdef VERLET_SKIN
+Real rv = verlet_cutoff + verlet_skin; // Radius cut off for verlet list
+#else
 Real rv = 1 + (2*speed*dt*(cell_update_period)); // Radius cut off for verlet list
+#endif
 
 // Parallel Use only
 const int tag_max = 32767; // For parallel use only
@@ -114,4 +165,24 @@ double digits =   100000000000000000;
 int the_node_id = 0;
 #endif
 
+#ifdef SPATIAL_REORDER
+int reorder_period = 4; // number of cell updates between two reorderings of the particle store
+#endif
+
+#ifdef AUTO_TUNE
+int tune_steps = 512; // number of steps that each candidate cell size and update period is timed
+Real tune_speed_factor = 2; // The speed bound of the cell sizes is this factor times the largest measured speed
+Real interaction_range = 1.1; // The largest interaction radius of the particles
+#endif
+
+#ifdef LOAD_BALANCE
+int balance_period = 16; // number of cell updates between two load balances
+Real balance_threshold = 1.1; // the cuts are moved only if the most loaded node has this factor of the average load
+#endif
+
+#ifdef TABULATED_FORCE
+Real table_error_bound = 1e-8; // maximum interpolation error of the force tables relative to the largest force in the table
+Real table_core = 0.5; // the tables start at table_core*cutoff, closer contacts use the exact force
+#endif
+
 #endif
@@ -0,0 +1,679 @@
+#ifndef _PARTICLE_STORE_
+#define _PARTICLE_STORE_
+
+#include "c2dvector.h"
+#include "parameters.h"
+#include "particle.h"
+#include "force-fields.h"
+
+/*
+	Structure of arrays container for repulsive particles (SOA_STORE in parameters.h).
+	Each degree of freedom is a separate contiguous column indexed by the particle id, the same index that is used for the particle array of the box and the pid list of cells.
+	The pair loops read only the columns they need (x, y, theta, ...) instead of dragging whole particle objects through the cache.
+	The particle objects of the box are still used for input, output and gathering. They are copied to the store with Load and the store is copied back with Export.
+	The dynamics is exactly the same as RepulsiveParticle and the statics of RepulsiveParticle (A_p, g, ...) are used as the parameters.
+	With SPATIAL_REORDER the slots are permuted so that close particles are close in memory. Then a slot is not the particle id: id[s] is the id of the particle in slot s and slot[i] is the slot of particle i.
+	Cells keep slots, the ids are only used to talk to the particle objects and to other nodes.
+	With DISTRIBUTED_STORE a node keeps only its own particles and the ghosts of its boundary cells in the first n slots. The columns grow when they are full, and slot is a hash map (Slot_Map) because the node does not know most of the ids.
+*/
+
+#ifdef DISTRIBUTED_STORE
+class Slot_Map{
+// Open addressing hash map from the particle id to the slot, with linear probing. The ids are not negative, -1 is an empty place.
+public:
+	vector<int> key, value;
+	int mask; // the size of the table minus one, the size is a power of two
+	int count; // number of the ids in the table
+
+	Slot_Map() {Clear(16);}
+	void Clear(int expected_count); // Emptying the table and sizing it for expected_count ids
+	inline int Find(int input_id) const; // The slot of the id, -1 if the id is not in the table
+	void Insert(int input_id, int input_slot);
+private:
+	inline int Hash(int input_id) const {return (int) ((((unsigned int) input_id)*2654435761u) & mask);}
+};
+
+void Slot_Map::Clear(int expected_count)
+{
+	int size = 16;
+	while (size < 2*expected_count)
+		size *= 2;
+	key.assign(size, -1);
+	value.resize(size);
+	mask = size - 1;
+	count = 0;
+}
+
+inline int Slot_Map::Find(int input_id) const
+{
+	for (int h = Hash(input_id); key[h] != -1; h = (h + 1) & mask)
+		if (key[h] == input_id)
+			return value[h];
+	return -1;
+}
+
+void Slot_Map::Insert(int input_id, int input_slot)
+{
+	if (2*(count+1) > (int) key.size())
+	{
+// The table is rehashed to twice its size to keep it at most half full
+		vector<int> old_key(key), old_value(value);
+		Clear(key.size());
+		for (int h = 0; h < old_key.size(); h++)
+			if (old_key[h] != -1)
+				Insert(old_key[h], old_value[h]);
+	}
+	int h = Hash(input_id);
+	while (key[h] != -1 && key[h] != input_id)
+		h = (h + 1) & mask;
+	if (key[h] == -1)
+		count++;
+	key[h] = input_id;
+	value[h] = input_slot;
+}
+#endif
+
+class Particle_Store{
+public:
+	int N; // Number of slots in each column
+	Real *x, *y; // position inside the box (periodic)
+	Real *theta; // self propulsion angle
+	Real *vx, *vy; // unit vector of the self propulsion direction (cos(theta), sin(theta))
+	Real *fx, *fy; // force acting on the particle
+	Real *torque; // torque acting on the particle
+	Real *x_original, *y_original; // position without periodic transformation
+	Real *x_old, *y_old, *theta_old; // position and angle at the begining of the step (Runge Kutta scratch)
+	Real *dtheta; // amount of noise added to theta
+	#ifdef RUNGE_KUTTA4
+		Real *k1_fx, *k1_fy, *k2_fx, *k2_fy, *k3_fx, *k3_fy; // forces of the first three stages of Runge Kutta
+		Real *k1_torque, *k2_torque, *k3_torque; // torques of the first three stages of Runge Kutta
+	#endif
+	#ifdef SPATIAL_REORDER
+		int *id; // id[s] is the id of the particle in slot s
+		#ifdef DISTRIBUTED_STORE
+			Slot_Map slot; // slot.Find(i) is the slot of particle i, -1 if the particle is not on this node
+			int n; // number of the used slots (the particles and the ghosts of the node), they are the first slots
+		#else
+			int *slot; // slot[i] is the slot of particle i
+		#endif
+	#endif
+
+	Particle_Store();
+	~Particle_Store();
+
+	void Init(int size); // Allocate the columns for size particles
+	void Delete(); // Free the columns
+
+	void Load(RepulsiveParticle* particle, int i); // Copy the state of particle[i] (particle[id[i]] with SPATIAL_REORDER) to the i'th slot
+	void Export(RepulsiveParticle* particle, int i) const; // Copy the state of the i'th slot back to particle[i] (particle[id[i]] with SPATIAL_REORDER)
+	#ifdef SPATIAL_REORDER
+		void Permute(const int* new_order); // The slot new_order[k] is moved to the slot k
+	#endif
+	#ifdef DISTRIBUTED_STORE
+		int Add_Slot(int input_id); // A new slot for the particle input_id at the end of the used slots
+		int Local_Slot(int input_id); // The slot of the particle, a new slot is added if the particle is not on this node
+		void Compact(const int* new_order, int new_n); // The slot new_order[k] is moved to the slot k for k < new_n, the other slots are dropped
+		void Load_Data(int i, const double* data); // Setting the i'th slot from the dof values that the nodes send to each other
+	#endif
+
+	void Reset(int i);
+	void Noise_Gen(int i);
+	#ifdef PHILOX_RNG
+		void Noise_Gen(const int* slot_list, int n); // The noise of a list of slots (a cell) in one batch. With PHILOX_RNG the moves do not draw the noise themselves, the cells call this first.
+	#endif
+	void Interact(int i, int j); // Interaction of particle i and particle j, the third Newton law is applied.
+	void Move(int i);
+	void Move_Runge_Kutta2_1(int i);
+	void Move_Runge_Kutta2_2(int i);
+	#ifdef RUNGE_KUTTA4
+		void Move_Runge_Kutta4_1(int i);
+		void Move_Runge_Kutta4_2(int i);
+		void Move_Runge_Kutta4_3(int i);
+		void Move_Runge_Kutta4_4(int i);
+	#endif
+
+private:
+	#ifdef SPATIAL_REORDER
+		void Permute_Column(Real* column, const int* new_order, Real* scratch, int count);
+		void Permute_Columns(const int* new_order, int count); // The first count slots of all the columns, except id, are permuted
+	#endif
+	#ifdef DISTRIBUTED_STORE
+		void Grow(int size); // Allocating size slots and keeping the used ones
+		void Grow_Column(Real*& column, int size);
+	#endif
+	void Periodic_Transform(Real& input_x, Real& input_y) const; // The same as C2DVector::Periodic_Transform
+	#ifdef PHILOX_RNG
+		vector<int> batch_id; // scratch of the batched noise generation
+		vector<Real> batch_noise;
+	#endif
+	void Update_Position(int i); // r = r_original with a periodic transformation
+};
+
+Particle_Store::Particle_Store()
+{
+	N = 0;
+}
+
+Particle_Store::~Particle_Store()
+{
+	Delete();
+}
+
+void Particle_Store::Init(int size)
+{
+	Delete();
+	N = size;
+	x = new Real[N];
+	y = new Real[N];
+	theta = new Real[N];
+	vx = new Real[N];
+	vy = new Real[N];
+	fx = new Real[N];
+	fy = new Real[N];
+	torque = new Real[N];
+	x_original = new Real[N];
+	y_original = new Real[N];
+	x_old = new Real[N];
+	y_old = new Real[N];
+	theta_old = new Real[N];
+	dtheta = new Real[N];
+	#ifdef RUNGE_KUTTA4
+		k1_fx = new Real[N];
+		k1_fy = new Real[N];
+		k2_fx = new Real[N];
+		k2_fy = new Real[N];
+		k3_fx = new Real[N];
+		k3_fy = new Real[N];
+		k1_torque = new Real[N];
+		k2_torque = new Real[N];
+		k3_torque = new Real[N];
+	#endif
+	#ifdef SPATIAL_REORDER
+		id = new int[N];
+		#ifdef DISTRIBUTED_STORE
+			n = 0;
+			slot.Clear(N);
+		#else
+		slot = new int[N];
+		for (int i = 0; i < N; i++)
+			id[i] = slot[i] = i;
+		#endif
+	#endif
+}
+
+void Particle_Store::Delete()
+{
+	if (N == 0)
+		return;
+	delete [] x;
+	delete [] y;
+	delete [] theta;
+	delete [] vx;
+	delete [] vy;
+	delete [] fx;
+	delete [] fy;
+	delete [] torque;
+	delete [] x_original;
+	delete [] y_original;
+	delete [] x_old;
+	delete [] y_old;
+	delete [] theta_old;
+	delete [] dtheta;
+	#ifdef RUNGE_KUTTA4
+		delete [] k1_fx;
+		delete [] k1_fy;
+		delete [] k2_fx;
+		delete [] k2_fy;
+		delete [] k3_fx;
+		delete [] k3_fy;
+		delete [] k1_torque;
+		delete [] k2_torque;
+		delete [] k3_torque;
+	#endif
+	#ifdef SPATIAL_REORDER
+		delete [] id;
+		#ifndef DISTRIBUTED_STORE
+		delete [] slot;
+		#endif
+	#endif
+	N = 0;
+}
+
+void Particle_Store::Load(RepulsiveParticle* particle, int i)
+{
+	#ifdef SPATIAL_REORDER
+		const RepulsiveParticle& p = particle[id[i]];
+	#else
+		const RepulsiveParticle& p = particle[i];
+	#endif
+	x[i] = p.r.x;
+	y[i] = p.r.y;
+	theta[i] = p.theta;
+	vx[i] = p.v.x;
+	vy[i] = p.v.y;
+	fx[i] = p.f.x;
+	fy[i] = p.f.y;
+	torque[i] = p.torque;
+	x_original[i] = p.r_original.x;
+	y_original[i] = p.r_original.y;
+	x_old[i] = p.r_old.x;
+	y_old[i] = p.r_old.y;
+	theta_old[i] = p.theta_old;
+	dtheta[i] = p.dtheta;
+}
+
+void Particle_Store::Export(RepulsiveParticle* particle, int i) const
+{
+	#ifdef SPATIAL_REORDER
+		RepulsiveParticle& p = particle[id[i]];
+	#else
+		RepulsiveParticle& p = particle[i];
+	#endif
+	p.r.x = x[i];
+	p.r.y = y[i];
+	p.theta = theta[i];
+	p.v.x = vx[i];
+	p.v.y = vy[i];
+	p.f.x = fx[i];
+	p.f.y = fy[i];
+	p.torque = torque[i];
+	p.r_original.x = x_original[i];
+	p.r_original.y = y_original[i];
+	p.r_old.x = x_old[i];
+	p.r_old.y = y_old[i];
+	p.theta_old = theta_old[i];
+	p.dtheta = dtheta[i];
+}
+
+#ifdef SPATIAL_REORDER
+void Particle_Store::Permute_Column(Real* column, const int* new_order, Real* scratch, int count)
+{
+	for (int k = 0; k < count; k++)
+		scratch[k] = column[new_order[k]];
+	for (int k = 0; k < count; k++)
+		column[k] = scratch[k];
+}
+
+void Particle_Store::Permute_Columns(const int* new_order, int count)
+{
+	Real* scratch = new Real[count > 0 ? count : 1];
+	Permute_Column(x, new_order, scratch, count);
+	Permute_Column(y, new_order, scratch, count);
+	Permute_Column(theta, new_order, scratch, count);
+	Permute_Column(vx, new_order, scratch, count);
+	Permute_Column(vy, new_order, scratch, count);
+	Permute_Column(fx, new_order, scratch, count);
+	Permute_Column(fy, new_order, scratch, count);
+	Permute_Column(torque, new_order, scratch, count);
+	Permute_Column(x_original, new_order, scratch, count);
+	Permute_Column(y_original, new_order, scratch, count);
+	Permute_Column(x_old, new_order, scratch, count);
+	Permute_Column(y_old, new_order, scratch, count);
+	Permute_Column(theta_old, new_order, scratch, count);
+	Permute_Column(dtheta, new_order, scratch, count);
+	#ifdef RUNGE_KUTTA4
+		Permute_Column(k1_fx, new_order, scratch, count);
+		Permute_Column(k1_fy, new_order, scratch, count);
+		Permute_Column(k2_fx, new_order, scratch, count);
+		Permute_Column(k2_fy, new_order, scratch, count);
+		Permute_Column(k3_fx, new_order, scratch, count);
+		Permute_Column(k3_fy, new_order, scratch, count);
+		Permute_Column(k1_torque, new_order, scratch, count);
+		Permute_Column(k2_torque, new_order, scratch, count);
+		Permute_Column(k3_torque, new_order, scratch, count);
+	#endif
+	delete [] scratch;
+}
+
+void Particle_Store::Permute(const int* new_order)
+{
+	Permute_Columns(new_order, N);
+
+	int* old_id = new int[N];
+	for (int k = 0; k < N; k++)
+		old_id[k] = id[k];
+	for (int k = 0; k < N; k++)
+	{
+		id[k] = old_id[new_order[k]];
+		#ifdef DISTRIBUTED_STORE
+			slot.Insert(id[k], k);
+		#else
+		slot[id[k]] = k;
+		#endif
+	}
+	delete [] old_id;
+}
+#endif
+
+#ifdef DISTRIBUTED_STORE
+void Particle_Store::Grow_Column(Real*& column, int size)
+{
+	Real* new_column = new Real[size];
+	for (int i = 0; i < n; i++)
+		new_column[i] = column[i];
+	delete [] column;
+	column = new_column;
+}
+
+void Particle_Store::Grow(int size)
+{
+	Grow_Column(x, size);
+	Grow_Column(y, size);
+	Grow_Column(theta, size);
+	Grow_Column(vx, size);
+	Grow_Column(vy, size);
+	Grow_Column(fx, size);
+	Grow_Column(fy, size);
+	Grow_Column(torque, size);
+	Grow_Column(x_original, size);
+	Grow_Column(y_original, size);
+	Grow_Column(x_old, size);
+	Grow_Column(y_old, size);
+	Grow_Column(theta_old, size);
+	Grow_Column(dtheta, size);
+	#ifdef RUNGE_KUTTA4
+		Grow_Column(k1_fx, size);
+		Grow_Column(k1_fy, size);
+		Grow_Column(k2_fx, size);
+		Grow_Column(k2_fy, size);
+		Grow_Column(k3_fx, size);
+		Grow_Column(k3_fy, size);
+		Grow_Column(k1_torque, size);
+		Grow_Column(k2_torque, size);
+		Grow_Column(k3_torque, size);
+	#endif
+	int* new_id = new int[size];
+	for (int i = 0; i < n; i++)
+		new_id[i] = id[i];
+	delete [] id;
+	id = new_id;
+	N = size;
+}
+
+int Particle_Store::Add_Slot(int input_id)
+{
+	if (n == N)
+		Grow(2*N);
+	id[n] = input_id;
+	slot.Insert(input_id, n);
+	return (n++);
+}
+
+int Particle_Store::Local_Slot(int input_id)
+{
+	int s = slot.Find(input_id);
+	if (s == -1)
+		s = Add_Slot(input_id);
+	return (s);
+}
+
+void Particle_Store::Compact(const int* new_order, int new_n)
+{
+	Permute_Columns(new_order, new_n);
+
+	int* old_id = new int[new_n > 0 ? new_n : 1];
+	for (int k = 0; k < new_n; k++)
+		old_id[k] = id[new_order[k]];
+	n = new_n;
+	slot.Clear(n);
+	for (int k = 0; k < n; k++)
+	{
+		id[k] = old_id[k];
+		slot.Insert(id[k], k);
+	}
+	delete [] old_id;
+}
+
+void Particle_Store::Load_Data(int i, const double* data)
+{
+	x[i] = data[0];
+	y[i] = data[1];
+	theta[i] = data[2];
+	x_original[i] = data[3];
+	y_original[i] = data[4];
+	vx[i] = cos(theta[i]);
+	vy[i] = sin(theta[i]);
+	x_old[i] = y_old[i] = theta_old[i] = dtheta[i] = 0;
+	Reset(i);
+}
+#endif
+
+inline void Particle_Store::Periodic_Transform(Real& input_x, Real& input_y) const
+{
+	input_x -= Lx2*((int) floor(input_x / Lx2 + 0.5));
+	input_y -= Ly2*((int) floor(input_y / Ly2 + 0.5));
+}
+
+inline void Particle_Store::Update_Position(int i)
+{
+	x[i] = x_original[i];
+	y[i] = y_original[i];
+
+	#ifdef PERIODIC_BOUNDARY_CONDITION
+		Periodic_Transform(x[i], y[i]);
+	#endif
+}
+
+inline void Particle_Store::Reset(int i)
+{
+	torque[i] = 0;
+	fx[i] = vx[i];
+	fy[i] = vy[i];
+}
+
+inline void Particle_Store::Noise_Gen(int i)
+{
+	#ifdef PHILOX_RNG
+		#ifdef SPATIAL_REORDER
+			dtheta[i] = Philox::Gaussian(id[i],noise_stream,RepulsiveParticle::noise_amplitude);
+		#else
+			dtheta[i] = Philox::Gaussian(i,noise_stream,RepulsiveParticle::noise_amplitude);
+		#endif
+	#else
+	dtheta[i] = gsl_ran_gaussian(C2DVector::gsl_r,RepulsiveParticle::noise_amplitude);
+	#endif
+}
+
+#ifdef PHILOX_RNG
+void Particle_Store::Noise_Gen(const int* slot_list, int n)
+{
+	batch_id.resize(n);
+	batch_noise.resize(n);
+	for (int k = 0; k < n; k++)
+		#ifdef SPATIAL_REORDER
+			batch_id[k] = id[slot_list[k]];
+		#else
+			batch_id[k] = slot_list[k];
+		#endif
+	Philox::Gaussian_Batch(&(batch_id[0]), n, noise_stream, RepulsiveParticle::noise_amplitude, &(batch_noise[0]));
+	for (int k = 0; k < n; k++)
+		dtheta[slot_list[k]] = batch_noise[k];
+}
+#endif
+
+inline void Particle_Store::Interact(int i, int j)
+{
+	C2DVector dr;
+	dr.x = x[i] - x[j];
+	dr.y = y[i] - y[j];
+	#ifdef PERIODIC_BOUNDARY_CONDITION
+		Periodic_Transform(dr.x, dr.y);
+	#endif
+	Real d2 = dr.Square();
+	Real d = sqrt(d2);
+
+	if (d < RepulsiveParticle::repulsion_radius)
+	{
+		C2DVector interaction_force = RepulsiveParticle::repulsion.Force(dr,d);
+
+		fx[i] += interaction_force.x;
+		fy[i] += interaction_force.y;
+		fx[j] -= interaction_force.x;
+		fy[j] -= interaction_force.y;
+	}
+
+	if (d < RepulsiveParticle::alignment_radius)
+	{
+		Real torque_interaction = RepulsiveParticle::g*Alignment_Sin(theta[i], vx[i], vy[i], theta[j], vx[j], vy[j]) / (PI*RepulsiveParticle::alignment_radius*RepulsiveParticle::alignment_radius);
+
+		torque[i] += torque_interaction;
+		torque[j] -= torque_interaction;
+	}
+}
+
+inline void Particle_Store::Move(int i)
+{
+	#ifndef PHILOX_RNG
+		Noise_Gen(i);
+	#endif
+	theta[i] += dt*(torque[i]);
+	theta[i] += dtheta[i];  // add noise
+	vx[i] = cos(theta[i]);
+	vy[i] = sin(theta[i]);
+
+	x_original[i] += fx[i]*dt;
+	y_original[i] += fy[i]*dt;
+	Update_Position(i);
+
+	Reset(i);
+}
+
+inline void Particle_Store::Move_Runge_Kutta2_1(int i) // half step forward
+{
+	#ifndef PHILOX_RNG
+		Noise_Gen(i);
+	#endif
+
+	theta_old[i] = theta[i];
+	x_old[i] = x_original[i];
+	y_old[i] = y_original[i];
+
+	theta[i] += half_dt*torque[i];
+	theta[i] += dtheta[i]/2;
+
+	theta[i] = theta[i] - floor(theta[i]/(2*M_PI) + 0.5)*2*M_PI; // -PI < theta < PI
+
+	vx[i] = cos(theta[i]);
+	vy[i] = sin(theta[i]);
+
+	x[i] += fx[i]*half_dt;
+	y[i] += fy[i]*half_dt;
+
+	#ifdef PERIODIC_BOUNDARY_CONDITION
+		Periodic_Transform(x[i], y[i]);
+	#endif
+
+	Reset(i);
+}
+
+inline void Particle_Store::Move_Runge_Kutta2_2(int i) // one step forward
+{
+	theta[i] = theta_old[i] + dt*torque[i];
+	theta[i] += dtheta[i];
+
+	theta[i] = theta[i] - floor(theta[i]/(2*M_PI) + 0.5)*2*M_PI;
+
+	vx[i] = cos(theta[i]);
+	vy[i] = sin(theta[i]);
+
+	x_original[i] = x_old[i] + fx[i]*dt;
+	y_original[i] = y_old[i] + fy[i]*dt;
+	Update_Position(i);
+
+	Reset(i);
+}
+
+#ifdef RUNGE_KUTTA4
+inline void Particle_Store::Move_Runge_Kutta4_1(int i) // half step forward
+{
+	#ifndef PHILOX_RNG
+		Noise_Gen(i);
+	#endif
+
+	theta_old[i] = theta[i];
+	x_old[i] = x_original[i];
+	y_old[i] = y_original[i];
+
+	theta[i] += half_dt*torque[i];
+	theta[i] += dtheta[i]/2;
+
+	theta[i] = theta[i] - floor(theta[i]/(2*M_PI) + 0.5)*2*M_PI; // -PI < theta < PI
+
+	vx[i] = cos(theta[i]);
+	vy[i] = sin(theta[i]);
+
+	x[i] += fx[i]*half_dt;
+	y[i] += fy[i]*half_dt;
+
+	#ifdef PERIODIC_BOUNDARY_CONDITION
+		Periodic_Transform(x[i], y[i]);
+	#endif
+
+	k1_fx[i] = fx[i];
+	k1_fy[i] = fy[i];
+	k1_torque[i] = torque[i];
+
+	Reset(i);
+}
+
+inline void Particle_Store::Move_Runge_Kutta4_2(int i) // half step forward correction
+{
+	theta[i] = theta_old[i] + half_dt*torque[i];
+	theta[i] += dtheta[i]/2;
+
+	theta[i] = theta[i] - floor(theta[i]/(2*M_PI) + 0.5)*2*M_PI;
+
+	vx[i] = cos(theta[i]);
+	vy[i] = sin(theta[i]);
+
+	x_original[i] = x_old[i] + fx[i]*half_dt;
+	y_original[i] = y_old[i] + fy[i]*half_dt;
+	Update_Position(i);
+
+	k2_fx[i] = fx[i];
+	k2_fy[i] = fy[i];
+	k2_torque[i] = torque[i];
+
+	Reset(i);
+}
+
+inline void Particle_Store::Move_Runge_Kutta4_3(int i) // full step forward
+{
+	theta[i] = theta_old[i] + dt*torque[i];
+	theta[i] += dtheta[i];
+
+	theta[i] = theta[i] - floor(theta[i]/(2*M_PI) + 0.5)*2*M_PI;
+
+	vx[i] = cos(theta[i]);
+	vy[i] = sin(theta[i]);
+
+	x_original[i] = x_old[i] + fx[i]*dt;
+	y_original[i] = y_old[i] + fy[i]*dt;
+	Update_Position(i);
+
+	k3_fx[i] = fx[i];
+	k3_fy[i] = fy[i];
+	k3_torque[i] = torque[i];
+
+	Reset(i);
+}
+
+inline void Particle_Store::Move_Runge_Kutta4_4(int i) // full step forward corrected
+{
+	theta[i] = theta_old[i] + (k1_torque[i] + k2_torque[i]*2 + k3_torque[i]*2 + torque[i])*dt_over_6;
+	theta[i] += dtheta[i];
+
+	theta[i] = theta[i] - floor(theta[i]/(2*M_PI) + 0.5)*2*M_PI;
+
+	vx[i] = cos(theta[i]);
+	vy[i] = sin(theta[i]);
+
+	x_original[i] = x_old[i] + (k1_fx[i] + k2_fx[i]*2 + k3_fx[i]*2 + fx[i])*dt_over_6;
+	y_original[i] = y_old[i] + (k1_fy[i] + k2_fy[i]*2 + k3_fy[i]*2 + fy[i])*dt_over_6;
+	Update_Position(i);
+
+	Reset(i);
+}
+#endif
+
+#endif
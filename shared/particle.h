@@ -5,6 +5,9 @@
 #include "parameters.h"
 #include "force-fields.h"
 #include <vector>
+#ifdef TABULATED_FORCE
+	#include "force-table.h"
+#endif
 
 //###################################################################
 class BasicParticle00{
@@ -54,6 +57,9 @@ public:
 	static Real noise_amplitude;
 	static Real speed;
 	vector<int> neighbor_id; // id of neighboring particles
+	#ifdef PHILOX_RNG
+		int id; // The global index of the particle in the box, it is the counter of its random numbers.
+	#endif
 
 	void Init();
 	void Init(C2DVector);
@@ -151,7 +157,11 @@ public:
 			average_theta /= neighbor_size;
 		else
 			average_theta = theta;
+		#ifdef PHILOX_RNG
+			theta = average_theta + noise_amplitude*(2*Philox::Uniform(id,noise_stream) - 1)*M_PI;
+		#else
 		theta = average_theta + noise_amplitude*gsl_ran_flat(C2DVector::gsl_r,-M_PI,M_PI);
+		#endif
 		C2DVector old_v = v;
 		v.x = cos(theta);
 		v.y = sin(theta);
@@ -195,11 +205,19 @@ public:
 	C2DVector average_v;
 	static Real beta;
 	static Real rc;
+	#ifdef TABULATED_FORCE
+		static Force_Table sigmoid_table; // beta/(1 + exp(d/rc-2)) in d for d < rc
+		static void Set_sigmoid(const Real input_beta, const Real input_rc);
+	#endif
 	void Move()
 	{
 		if (neighbor_size == 0)
 			average_v = v;
+		#ifdef PHILOX_RNG
+			Real rand_angle = (2*Philox::Uniform(id,noise_stream) - 1)*M_PI;
+		#else
 		Real rand_angle = gsl_ran_flat(C2DVector::gsl_r,-M_PI,M_PI);
+		#endif
 		average_v.x += neighbor_size*noise_amplitude*cos(rand_angle);
 		average_v.y += neighbor_size*noise_amplitude*sin(rand_angle);
 		theta = atan2(average_v.y,average_v.x);
@@ -238,7 +256,11 @@ public:
 			p.average_v += v;
 			if (d < rc)
 			{
-				Real force_amplitude = beta/(1 + exp(d/rc-2));
+				#ifdef TABULATED_FORCE
+					Real force_amplitude = sigmoid_table(d);
+				#else
+					Real force_amplitude = beta/(1 + exp(d/rc-2));
+				#endif
 				average_v += ehat*force_amplitude;
 				p.average_v -= ehat*force_amplitude;
 			}
@@ -248,6 +270,23 @@ public:
 
 Real VicsekParticle2::beta = 2.5;
 Real VicsekParticle2::rc = 0.127;
+
+#ifdef TABULATED_FORCE
+struct Sigmoid_Amplitude{
+	Real beta, rc;
+	Sigmoid_Amplitude(Real input_beta, Real input_rc) {beta = input_beta; rc = input_rc;}
+	Real operator()(const Real& d) const {return beta/(1 + exp(d/rc-2));}
+};
+
+Force_Table VicsekParticle2::sigmoid_table(Sigmoid_Amplitude(VicsekParticle2::beta, VicsekParticle2::rc), 0, VicsekParticle2::rc, table_error_bound);
+
+void VicsekParticle2::Set_sigmoid(const Real input_beta, const Real input_rc)
+{
+	beta = input_beta;
+	rc = input_rc;
+	sigmoid_table.Build(Sigmoid_Amplitude(beta, rc), 0, rc, table_error_bound);
+}
+#endif
 //###################################################################
 
 //###################################################################
@@ -270,7 +309,11 @@ public:
 		#ifdef COMPARE
 			torque = round(digits*torque)/digits;
 		#endif
+		#ifdef PHILOX_RNG
+			torque = g*torque + Philox::Gaussian(id,noise_stream,noise_amplitude);
+		#else
 		torque = g*torque + gsl_ran_gaussian(C2DVector::gsl_r,noise_amplitude);
+		#endif
 		theta += torque*dt;
 //		theta -= 2*PI * ((int) (theta / (PI)));
 		C2DVector old_v = v;
@@ -278,8 +321,15 @@ public:
 		v.y = sin(theta);
 
 		r += v*(speed*dt);
+		#ifdef PHILOX_RNG
+			Real kick_x, kick_y;
+			Philox::Gaussian_Pair(id,kick_stream,Kamp,kick_x,kick_y);
+			r.x += kick_x;
+			r.y += kick_y;
+		#else
 		r.x += gsl_ran_gaussian(C2DVector::gsl_r,Kamp);
 		r.y += gsl_ran_gaussian(C2DVector::gsl_r,Kamp);
+		#endif
 		#ifdef PERIODIC_BOUNDARY_CONDITION
 			r.Periodic_Transform();
 		#endif
@@ -309,7 +359,7 @@ public:
 
 			Real d = sqrt(d2);
 
-			torque_interaction = (1-alpha)*sin(p.theta - theta)/(PI);
+			torque_interaction = (1-alpha)*Alignment_Sin(theta, v, p.theta, p.v)/(PI);
 
 			torque += torque_interaction;
 			p.torque -= torque_interaction;
@@ -396,7 +446,11 @@ public:
 		#ifdef COMPARE
 			torque = round(digits*torque)/digits;
 		#endif
+		#ifdef PHILOX_RNG
+			torque = torque + Philox::Gaussian(id,noise_stream,noise_amplitude);
+		#else
 		torque = torque + gsl_ran_gaussian(C2DVector::gsl_r,noise_amplitude);
+		#endif
 		theta += torque*dt;
 //		theta -= 2*PI * ((int) (theta / (PI)));
 		C2DVector old_v = v;
@@ -433,7 +487,7 @@ public:
 			{
 				neighbor_size++;
 				p.neighbor_size++;
-				torque_interaction = mu_plus*(1-(d2/(kisi_a*kisi_a)))*sin(p.theta - theta);
+				torque_interaction = mu_plus*(1-(d2/(kisi_a*kisi_a)))*Alignment_Sin(theta, v, p.theta, p.v);
 				torque += torque_interaction;
 				p.torque -= torque_interaction;
 			}
@@ -441,7 +495,7 @@ public:
 			{
 				neighbor_size++;
 				p.neighbor_size++;
-				torque_interaction = mu_minus*4*(d - kisi_a)*(1-d)*sin(theta - p.theta) / ((1-kisi_a)*(1-kisi_a));
+				torque_interaction = mu_minus*4*(d - kisi_a)*(1-d)*Alignment_Sin(p.theta, p.v, theta, v) / ((1-kisi_a)*(1-kisi_a));
 				torque += torque_interaction;
 				p.torque -= torque_interaction;
 			}
@@ -514,6 +568,11 @@ public:
 	static Real A_w;
 	static Real g_w;
 	static int nb;
+	static R12_Repulsive_Truncated_Field repulsion; // repulsion between particles with its constants computed in the Set functions
+	static Yukawa_Truncated_Field wall_repulsion; // repulsion of the walls with its constants computed in Set_wall
+	#ifdef TABULATED_FORCE
+		static Force_Table wall_table; // A_w times the shape of wall_repulsion in d^2, built in Set_wall
+	#endif
 	#ifdef RUNGE_KUTTA4
 		C2DVector k1_f,k2_f,k3_f,k4_f;
 		Real k1_torque, k2_torque, k3_torque, k4_torque;
@@ -528,6 +587,7 @@ public:
 	static void Set_A_p(const Real);
 	static void Set_g(const Real);
 	static void Set_nb(const int);
+	static void Set_wall(const Real input_r_c_w, const Real input_sigma_w, const Real input_A_w);
 
 	void Reset();
 	void Move();
@@ -549,12 +609,22 @@ RepulsiveParticle::RepulsiveParticle()
 }
 
 void RepulsiveParticle::Set_F0(const Real input_F0) {F0 = input_F0;}
-void RepulsiveParticle::Set_sigma_p(const Real input_sigma_p)  {sigma_p = input_sigma_p;}
-void RepulsiveParticle::Set_repulsion_radius(const Real input_repulsion_radius) {repulsion_radius = input_repulsion_radius;}
+void RepulsiveParticle::Set_sigma_p(const Real input_sigma_p)  {sigma_p = input_sigma_p; repulsion.Set(repulsion_radius,sigma_p,A_p);}
+void RepulsiveParticle::Set_repulsion_radius(const Real input_repulsion_radius) {repulsion_radius = input_repulsion_radius; repulsion.Set(repulsion_radius,sigma_p,A_p);}
 void RepulsiveParticle::Set_alignment_radius(const Real input_alignment_radius) {alignment_radius = input_alignment_radius;}
-void RepulsiveParticle::Set_A_p(const Real input_A_p) {A_p = input_A_p;}
+void RepulsiveParticle::Set_A_p(const Real input_A_p) {A_p = input_A_p; repulsion.Set(repulsion_radius,sigma_p,A_p);}
 void RepulsiveParticle::Set_g(const Real input_g) {g = input_g;}
 void RepulsiveParticle::Set_nb(const int input_nb) {nb = input_nb;}
+void RepulsiveParticle::Set_wall(const Real input_r_c_w, const Real input_sigma_w, const Real input_A_w)
+{
+	r_c_w = input_r_c_w;
+	sigma_w = input_sigma_w;
+	A_w = input_A_w;
+	wall_repulsion.Set(r_c_w,sigma_w,A_w);
+	#ifdef TABULATED_FORCE
+		wall_table.Build(Field_Magnitude<Yukawa_Truncated_Field>(wall_repulsion), table_core*table_core*r_c_w*r_c_w, r_c_w*r_c_w, table_error_bound);
+	#endif
+}
 
 void RepulsiveParticle::Reset()
 {
@@ -565,7 +635,11 @@ void RepulsiveParticle::Reset()
 
 inline void RepulsiveParticle::Noise_Gen()
 {
+	#ifdef PHILOX_RNG
+		dtheta = Philox::Gaussian(id,noise_stream,noise_amplitude);
+	#else
 	dtheta =  gsl_ran_gaussian(C2DVector::gsl_r,noise_amplitude);
+	#endif
 }
 
 inline void RepulsiveParticle::Move()
@@ -737,7 +811,7 @@ void RepulsiveParticle::Interact(RepulsiveParticle& p)
 	C2DVector interaction_force;
 	if (d < repulsion_radius)
 	{
-		interaction_force = R12_Repulsive_Truncated(dr,d,repulsion_radius,sigma_p,A_p);
+		interaction_force = repulsion.Force(dr,d);
 
 		f += interaction_force;
 		p.f -= interaction_force;
@@ -749,7 +823,7 @@ void RepulsiveParticle::Interact(RepulsiveParticle& p)
 		neighbor_size++;
 		p.neighbor_size++;
 
-		torque_interaction = g*sin(p.theta - theta) / (PI*alignment_radius*alignment_radius);
+		torque_interaction = g*Alignment_Sin(theta, v, p.theta, p.v) / (PI*alignment_radius*alignment_radius);
 
 		torque += torque_interaction;
 		p.torque -= torque_interaction;
@@ -784,6 +858,11 @@ Real RepulsiveParticle::A_w;
 Real RepulsiveParticle::sigma_w;
 Real RepulsiveParticle::g_w;
 int RepulsiveParticle::nb = 1;
+R12_Repulsive_Truncated_Field RepulsiveParticle::repulsion(RepulsiveParticle::repulsion_radius,RepulsiveParticle::sigma_p,RepulsiveParticle::A_p);
+Yukawa_Truncated_Field RepulsiveParticle::wall_repulsion;
+#ifdef TABULATED_FORCE
+Force_Table RepulsiveParticle::wall_table;
+#endif
 
 //###################################################################
 
@@ -806,6 +885,7 @@ public:
 	static Real sigma_p;
 	static Real repulsion_radius;
 	static Real A_p;
+	static R12_Repulsive_Truncated_Field repulsion; // repulsion between beads with its constants computed in the Set functions
 	static Real torque0; // The intrinsinc torque in the particle. This make the motion chiral
 	static Real R0; // The intrinsinc radius of motion. This make the motion chiral
 
@@ -836,9 +916,9 @@ ActiveBrownianChain::ActiveBrownianChain()
 }
 
 void ActiveBrownianChain::Set_F0(const Real input_F0) {F0 = input_F0;}
-void ActiveBrownianChain::Set_sigma_p(const Real input_sigma_p)  {sigma_p = input_sigma_p;}
-void ActiveBrownianChain::Set_repulsion_radius(const Real input_repulsion_radius) {repulsion_radius = input_repulsion_radius;}
-void ActiveBrownianChain::Set_A_p(const Real input_A_p) {A_p = input_A_p;}
+void ActiveBrownianChain::Set_sigma_p(const Real input_sigma_p)  {sigma_p = input_sigma_p; repulsion.Set(repulsion_radius,sigma_p,A_p);}
+void ActiveBrownianChain::Set_repulsion_radius(const Real input_repulsion_radius) {repulsion_radius = input_repulsion_radius; repulsion.Set(repulsion_radius,sigma_p,A_p);}
+void ActiveBrownianChain::Set_A_p(const Real input_A_p) {A_p = input_A_p; repulsion.Set(repulsion_radius,sigma_p,A_p);}
 void ActiveBrownianChain::Set_torque0(const Real input_torque0) {torque0 = input_torque0;}
 
 void ActiveBrownianChain::Set_R0(const Real input_R0) // Should be called after set nb
@@ -881,7 +961,11 @@ void ActiveBrownianChain::Set_Parameters(int input_nb, Real input_F0)
 
 inline void ActiveBrownianChain::Noise_Gen()
 {
+	#ifdef PHILOX_RNG
+		dtheta = Philox::Gaussian(id,noise_stream,noise_amplitude);
+	#else
 	dtheta =  gsl_ran_gaussian(C2DVector::gsl_r,noise_amplitude);
+	#endif
 }
 
 inline void ActiveBrownianChain::Move()
@@ -972,7 +1056,7 @@ inline void ActiveBrownianChain::Interact(ActiveBrownianChain& ac)
 			C2DVector interaction_force;
 			if (d < repulsion_radius)
 			{
-				interaction_force = R12_Repulsive_Truncated(dr,d,repulsion_radius,sigma_p,A_p);
+				interaction_force = repulsion.Force(dr,d);
 
 				f += interaction_force;
 				ac.f -= interaction_force;
@@ -1015,6 +1099,7 @@ void ActiveBrownianChain::Write(std::ostream& os)
 Real ActiveBrownianChain::A_p = 1.;		// interaction strength
 Real ActiveBrownianChain::sigma_p = 1.0;		// sigma in Yukawa Potential
 Real ActiveBrownianChain::repulsion_radius = 1.1;		// repulsive cutoff radius
+R12_Repulsive_Truncated_Field ActiveBrownianChain::repulsion(ActiveBrownianChain::repulsion_radius,ActiveBrownianChain::sigma_p,ActiveBrownianChain::A_p);
 Real ActiveBrownianChain::torque0 = 0; // The intrinsinc torque in the particle. This make the motion chiral
 Real ActiveBrownianChain::R0 = 0; // The intrinsinc radius of motion. This make the motion chiral
 //###################################################################
@@ -1054,10 +1139,20 @@ inline void RTPChain::Noise_Gen()
 {
 	if (tumble_flag == 0)
 	{
+		#ifdef PHILOX_RNG
+			uint32_t word[4];
+			Philox::Block(id,tumble_stream,Philox::step,word);
+			Real random_number = word[0] * (1.0/4294967296.0);
+		#else
 		Real random_number = gsl_rng_uniform(C2DVector::gsl_r);
+		#endif
 		if (random_number < lambda*dt)
 		{
+			#ifdef PHILOX_RNG
+				tumble_flag = 2*(word[1] & 1) - 1;
+			#else
 			tumble_flag = 2*gsl_rng_uniform_int(C2DVector::gsl_r,2) - 1;
+			#endif
 			tumble_elapesed_time += dt;
 		}
 	}
@@ -1102,8 +1197,13 @@ public:
 		#ifdef COMPARE
 			torque = round(digits*torque)/digits;
 		#endif
+		#ifdef PHILOX_RNG
+			torque = g*torque + Philox::Gaussian(id,noise_stream,noise_amplitude);
+			torque_phi = torque_phi + Philox::Gaussian(id,phi_stream,noise_amplitude_phi);
+		#else
 		torque = g*torque + gsl_ran_gaussian(C2DVector::gsl_r,noise_amplitude);
 		torque_phi = torque_phi + gsl_ran_gaussian(C2DVector::gsl_r,noise_amplitude_phi);
+		#endif
 		theta += torque*dt;
 		phi += torque_phi*dt;
 
@@ -1113,8 +1213,15 @@ public:
 
 		speed = vmid + vamp*cos(phi);
 		r += v*(speed*dt);
+		#ifdef PHILOX_RNG
+			Real kick_x, kick_y;
+			Philox::Gaussian_Pair(id,kick_stream,Kamp,kick_x,kick_y);
+			r.x += kick_x;
+			r.y += kick_y;
+		#else
 		r.x += gsl_ran_gaussian(C2DVector::gsl_r,Kamp);
 		r.y += gsl_ran_gaussian(C2DVector::gsl_r,Kamp);
+		#endif
 		#ifdef PERIODIC_BOUNDARY_CONDITION
 			r.Periodic_Transform();
 		#endif
@@ -1143,7 +1250,7 @@ public:
 			neighbor_size++;
 			p.neighbor_size++;
 
-			torque_interaction = (1-alpha)*sin(p.theta - theta)/(PI);
+			torque_interaction = (1-alpha)*Alignment_Sin(theta, v, p.theta, p.v)/(PI);
 
 			torque += torque_interaction;
 			p.torque -= torque_interaction;
@@ -0,0 +1,112 @@
+#ifndef _PHILOX_
+#define _PHILOX_
+
+#include "parameters.h"
+#include <stdint.h>
+
+/*
+	Counter based random numbers (Philox4x32-10, Salmon et al. SC11). A random number is a pure function of the key (the seed) and a counter,
+	here the counter is (global particle id, stream, step), so the noise of a particle does not depend on the order that the particles are moved in, on the node that owns the particle or on the number of nodes.
+	There is no state to copy except the step counter, and the noise of many particles can be generated independently (in parallel or in SIMD lanes).
+	Each place in the code that draws noise in a step has its own stream number, the Philox_Stream_Id enum below.
+*/
+
+enum Philox_Stream_Id{
+	noise_stream = 0, // the rotational noise (Noise_Gen and the torque noise of the continuous particles)
+	kick_stream = 1, // the translational thermal kicks (x and y)
+	phi_stream = 2, // the noise of the internal phase of EjtehadiParticle
+	tumble_stream = 3 // the tumbles of RTPChain
+};
+
+class Philox{
+public:
+	static uint32_t key[2]; // The seed. It must be the same on all nodes.
+	static uint64_t step; // The number of steps that are done. The nodes increase it after each move, it is the only state of the generator.
+
+	static void Init(uint64_t seed);
+	static inline void Block(uint32_t id, uint32_t stream, uint64_t input_step, uint32_t output[4]); // Four random 32 bit words of the counter (id, stream, input_step)
+	static inline Real Uniform(uint32_t id, uint32_t stream); // Uniform in [0,1)
+	static inline Real Gaussian(uint32_t id, uint32_t stream, Real sigma); // Gaussian with standard deviation sigma
+	static inline void Gaussian_Pair(uint32_t id, uint32_t stream, Real sigma, Real& g0, Real& g1); // Two independent gaussians of one block (Box-Muller)
+	static void Gaussian_Batch(const int* id, int n, uint32_t stream, Real sigma, Real* output); // The gaussian of each id of a list, the loop has no dependency between the ids.
+
+private:
+	static inline void Round(uint32_t counter[4], const uint32_t round_key[2]);
+	static inline Real To_Uniform(uint32_t high, uint32_t low); // 53 bit uniform in [0,1) from two words
+};
+
+uint32_t Philox::key[2] = {0, 0};
+uint64_t Philox::step = 0;
+
+void Philox::Init(uint64_t seed)
+{
+	key[0] = (uint32_t) seed;
+	key[1] = (uint32_t) (seed >> 32);
+	step = 0;
+}
+
+inline void Philox::Round(uint32_t counter[4], const uint32_t round_key[2])
+{
+	uint64_t product0 = (uint64_t) 0xD2511F53u * counter[0];
+	uint64_t product1 = (uint64_t) 0xCD9E8D57u * counter[2];
+	uint32_t high0 = (uint32_t) (product0 >> 32), low0 = (uint32_t) product0;
+	uint32_t high1 = (uint32_t) (product1 >> 32), low1 = (uint32_t) product1;
+	counter[0] = high1 ^ counter[1] ^ round_key[0];
+	counter[1] = low1;
+	counter[2] = high0 ^ counter[3] ^ round_key[1];
+	counter[3] = low0;
+}
+
+inline void Philox::Block(uint32_t id, uint32_t stream, uint64_t input_step, uint32_t output[4])
+{
+	output[0] = id;
+	output[1] = stream;
+	output[2] = (uint32_t) input_step;
+	output[3] = (uint32_t) (input_step >> 32);
+	uint32_t round_key[2] = {key[0], key[1]};
+	for (int r = 0; r < 10; r++)
+	{
+		Round(output, round_key);
+		round_key[0] += 0x9E3779B9u;
+		round_key[1] += 0xBB67AE85u;
+	}
+}
+
+inline Real Philox::To_Uniform(uint32_t high, uint32_t low)
+{
+	uint64_t bits = (((uint64_t) high << 32) | low) >> 11;
+	return (bits * (1.0/9007199254740992.0));
+}
+
+inline Real Philox::Uniform(uint32_t id, uint32_t stream)
+{
+	uint32_t word[4];
+	Block(id, stream, step, word);
+	return (To_Uniform(word[0], word[1]));
+}
+
+inline void Philox::Gaussian_Pair(uint32_t id, uint32_t stream, Real sigma, Real& g0, Real& g1)
+{
+	uint32_t word[4];
+	Block(id, stream, step, word);
+	Real u1 = 1.0 - To_Uniform(word[0], word[1]); // in (0,1] for the log
+	Real u2 = To_Uniform(word[2], word[3]);
+	Real radius = sigma*sqrt(-2*log(u1));
+	g0 = radius*cos(2*M_PI*u2);
+	g1 = radius*sin(2*M_PI*u2);
+}
+
+inline Real Philox::Gaussian(uint32_t id, uint32_t stream, Real sigma)
+{
+	Real g0, g1;
+	Gaussian_Pair(id, stream, sigma, g0, g1);
+	return (g0);
+}
+
+void Philox::Gaussian_Batch(const int* id, int n, uint32_t stream, Real sigma, Real* output)
+{
+	for (int i = 0; i < n; i++)
+		output[i] = Gaussian(id[i], stream, sigma);
+}
+
+#endif
@@ -0,0 +1,352 @@
+#ifndef _SIMD_KERNEL_
+#define _SIMD_KERNEL_
+
+#include "parameters.h"
+#include "particle-store.h"
+
+#ifndef SOA_STORE
+	#error "SIMD_KERNEL works on the particle store, SOA_STORE must be defined as well."
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+	#include <immintrin.h>
+	#define SIMD_KERNEL_X86
+#endif
+
+/*
+	Pair kernels of repulsive particles (SIMD_KERNEL in parameters.h).
+	A kernel interacts the particles of one cell (ids ia[0] ... ia[na-1]) with the particles of a neighboring cell (ids jb[0] ... jb[nb-1]), or with the rest of the same cell when self is true.
+	The neighboring cell is packed to contiguous buffers once, then each particle of the first cell runs against the whole pack in lanes. The force and torque of the particle are accumulated in lanes and reduced at the end, the partners get the opposite values in the pack (third Newton law) which is added back to the store at the end.
+	The alignment torque uses the cached headings, sin(theta_j - theta_i) = vx_i*vy_j - vy_i*vx_j, because there is no vector sin. Therefore the result agrees with Particle_Store::Interact up to the rounding errors.
+	The kernel is chosen at run time according to the cpu (AVX-512, AVX2 or scalar) by Select_Pair_Kernel.
+*/
+
+typedef void (*Pair_Kernel)(Particle_Store* s, const int* ia, int na, const int* jb, int nb, bool self);
+
+// The constants of the pair interaction that are the same for all pairs
+struct Pair_Constants{
+	Real repulsion_radius, sigma, amplitude;
+	Real sigma_over_cutoff13; // (sigma/repulsion_radius)^13 is subtracted to truncate the force at the cutoff
+	Real alignment_radius;
+	Real torque_coefficient; // g / (PI*alignment_radius^2)
+
+	Pair_Constants()
+	{
+		repulsion_radius = RepulsiveParticle::repulsion.cutoff;
+		sigma = RepulsiveParticle::repulsion.sigma;
+		amplitude = RepulsiveParticle::repulsion.amplitude;
+		sigma_over_cutoff13 = RepulsiveParticle::repulsion.shift;
+		alignment_radius = RepulsiveParticle::alignment_radius;
+		torque_coefficient = RepulsiveParticle::g / (PI*alignment_radius*alignment_radius);
+	}
+};
+
+// Contiguous copy of the particles of a cell. The length is padded to a multiple of 8 lanes, the padded lanes are never active.
+struct Cell_Pack{
+	vector<Real> x, y, vx, vy; // packed positions and headings
+	vector<Real> fx, fy, torque; // reaction force and torque of the partners
+	int n;
+
+	void Load(const Particle_Store* s, const int* jb, int nb)
+	{
+		n = nb;
+		int padded = (nb + 7) & ~7;
+		if (x.size() < padded)
+		{
+			x.resize(padded);
+			y.resize(padded);
+			vx.resize(padded);
+			vy.resize(padded);
+			fx.resize(padded);
+			fy.resize(padded);
+			torque.resize(padded);
+		}
+		for (int k = 0; k < padded; k++)
+		{
+			if (k < nb)
+			{
+				x[k] = s->x[jb[k]];
+				y[k] = s->y[jb[k]];
+				vx[k] = s->vx[jb[k]];
+				vy[k] = s->vy[jb[k]];
+			}
+			else
+				x[k] = y[k] = vx[k] = vy[k] = 0;
+			fx[k] = fy[k] = torque[k] = 0;
+		}
+	}
+
+	void Add_To(Particle_Store* s, const int* jb) const // Adding the reactions to the store
+	{
+		for (int k = 0; k < n; k++)
+		{
+			s->fx[jb[k]] += fx[k];
+			s->fy[jb[k]] += fy[k];
+			s->torque[jb[k]] += torque[k];
+		}
+	}
+};
+
+Cell_Pack cell_pack; // This buffer is reused by all kernel calls
+
+void Pair_Kernel_Scalar(Particle_Store* s, const int* ia, int na, const int* jb, int nb, bool self)
+{
+	Pair_Constants c;
+	cell_pack.Load(s, jb, nb);
+	Real* px = &(cell_pack.x[0]);
+	Real* py = &(cell_pack.y[0]);
+	Real* pvx = &(cell_pack.vx[0]);
+	Real* pvy = &(cell_pack.vy[0]);
+	Real* pfx = &(cell_pack.fx[0]);
+	Real* pfy = &(cell_pack.fy[0]);
+	Real* ptorque = &(cell_pack.torque[0]);
+
+	for (int a = 0; a < na; a++)
+	{
+		int i = ia[a];
+		Real xi = s->x[i], yi = s->y[i], vxi = s->vx[i], vyi = s->vy[i];
+		Real fxi = 0, fyi = 0, ti = 0;
+		for (int k = (self ? a+1 : 0); k < nb; k++)
+		{
+			Real dx = xi - px[k];
+			Real dy = yi - py[k];
+			#ifdef PERIODIC_BOUNDARY_CONDITION
+				dx -= Lx2*floor(dx / Lx2 + 0.5);
+				dy -= Ly2*floor(dy / Ly2 + 0.5);
+			#endif
+			Real d = sqrt(dx*dx + dy*dy);
+
+			if (d < c.repulsion_radius)
+			{
+				Real sigma_over_d = c.sigma / d;
+				Real sigma_over_d2 = sigma_over_d*sigma_over_d;
+				Real sigma_over_d4 = sigma_over_d2*sigma_over_d2;
+				Real sigma_over_d8 = sigma_over_d4*sigma_over_d4;
+				Real strength = c.amplitude*(sigma_over_d8*sigma_over_d4*sigma_over_d - c.sigma_over_cutoff13) / d;
+				fxi += strength*dx;
+				fyi += strength*dy;
+				pfx[k] -= strength*dx;
+				pfy[k] -= strength*dy;
+			}
+
+			if (d < c.alignment_radius)
+			{
+				Real torque_interaction = c.torque_coefficient*(vxi*pvy[k] - vyi*pvx[k]);
+				ti += torque_interaction;
+				ptorque[k] -= torque_interaction;
+			}
+		}
+		s->fx[i] += fxi;
+		s->fy[i] += fyi;
+		s->torque[i] += ti;
+	}
+	cell_pack.Add_To(s, jb);
+}
+
+#ifdef SIMD_KERNEL_X86
+__attribute__((target("avx2,fma")))
+void Pair_Kernel_AVX2(Particle_Store* s, const int* ia, int na, const int* jb, int nb, bool self)
+{
+	Pair_Constants c;
+	cell_pack.Load(s, jb, nb);
+	Real* px = &(cell_pack.x[0]);
+	Real* py = &(cell_pack.y[0]);
+	Real* pvx = &(cell_pack.vx[0]);
+	Real* pvy = &(cell_pack.vy[0]);
+	Real* pfx = &(cell_pack.fx[0]);
+	Real* pfy = &(cell_pack.fy[0]);
+	Real* ptorque = &(cell_pack.torque[0]);
+
+	const __m256d lx2 = _mm256_set1_pd(Lx2);
+	const __m256d ly2 = _mm256_set1_pd(Ly2);
+	const __m256d half = _mm256_set1_pd(0.5);
+	const __m256d repulsion_radius = _mm256_set1_pd(c.repulsion_radius);
+	const __m256d sigma = _mm256_set1_pd(c.sigma);
+	const __m256d amplitude = _mm256_set1_pd(c.amplitude);
+	const __m256d sigma_over_cutoff13 = _mm256_set1_pd(c.sigma_over_cutoff13);
+	const __m256d alignment_radius = _mm256_set1_pd(c.alignment_radius);
+	const __m256d torque_coefficient = _mm256_set1_pd(c.torque_coefficient);
+	const __m256d one = _mm256_set1_pd(1.0);
+	const __m256i lane = _mm256_setr_epi64x(0,1,2,3);
+	double lane_sum[4];
+
+	for (int a = 0; a < na; a++)
+	{
+		int i = ia[a];
+		int start = self ? a+1 : 0; // The first partner in the pack
+		if (start >= nb)
+			continue;
+		const __m256d xi = _mm256_set1_pd(s->x[i]);
+		const __m256d yi = _mm256_set1_pd(s->y[i]);
+		const __m256d vxi = _mm256_set1_pd(s->vx[i]);
+		const __m256d vyi = _mm256_set1_pd(s->vy[i]);
+		const __m256i first = _mm256_set1_epi64x(start - 1);
+		const __m256i last = _mm256_set1_epi64x(nb);
+
+		__m256d fxi = _mm256_setzero_pd();
+		__m256d fyi = _mm256_setzero_pd();
+		__m256d ti = _mm256_setzero_pd();
+
+		for (int k = start & ~3; k < nb; k += 4)
+		{
+// Active lanes are start <= k+lane < nb
+			__m256i index = _mm256_add_epi64(_mm256_set1_epi64x(k), lane);
+			const __m256d active = _mm256_castsi256_pd(_mm256_and_si256(_mm256_cmpgt_epi64(index, first), _mm256_cmpgt_epi64(last, index)));
+
+			__m256d dx = _mm256_sub_pd(xi, _mm256_loadu_pd(px + k));
+			__m256d dy = _mm256_sub_pd(yi, _mm256_loadu_pd(py + k));
+			#ifdef PERIODIC_BOUNDARY_CONDITION
+				dx = _mm256_sub_pd(dx, _mm256_mul_pd(lx2, _mm256_floor_pd(_mm256_add_pd(_mm256_div_pd(dx, lx2), half))));
+				dy = _mm256_sub_pd(dy, _mm256_mul_pd(ly2, _mm256_floor_pd(_mm256_add_pd(_mm256_div_pd(dy, ly2), half))));
+			#endif
+			__m256d d = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)));
+			d = _mm256_blendv_pd(one, d, active); // avoid a division by zero in the inactive lanes
+
+			__m256d repulsion_mask = _mm256_and_pd(active, _mm256_cmp_pd(d, repulsion_radius, _CMP_LT_OQ));
+			__m256d alignment_mask = _mm256_and_pd(active, _mm256_cmp_pd(d, alignment_radius, _CMP_LT_OQ));
+
+			__m256d sigma_over_d = _mm256_div_pd(sigma, d);
+			__m256d sigma_over_d2 = _mm256_mul_pd(sigma_over_d, sigma_over_d);
+			__m256d sigma_over_d4 = _mm256_mul_pd(sigma_over_d2, sigma_over_d2);
+			__m256d sigma_over_d8 = _mm256_mul_pd(sigma_over_d4, sigma_over_d4);
+			__m256d sigma_over_d13 = _mm256_mul_pd(_mm256_mul_pd(sigma_over_d8, sigma_over_d4), sigma_over_d);
+			__m256d strength = _mm256_div_pd(_mm256_mul_pd(amplitude, _mm256_sub_pd(sigma_over_d13, sigma_over_cutoff13)), d);
+			strength = _mm256_and_pd(repulsion_mask, strength);
+			__m256d fx = _mm256_mul_pd(strength, dx);
+			__m256d fy = _mm256_mul_pd(strength, dy);
+
+			__m256d t = _mm256_mul_pd(torque_coefficient, _mm256_sub_pd(_mm256_mul_pd(vxi, _mm256_loadu_pd(pvy + k)), _mm256_mul_pd(vyi, _mm256_loadu_pd(pvx + k))));
+			t = _mm256_and_pd(alignment_mask, t);
+
+			fxi = _mm256_add_pd(fxi, fx);
+			fyi = _mm256_add_pd(fyi, fy);
+			ti = _mm256_add_pd(ti, t);
+
+			_mm256_storeu_pd(pfx + k, _mm256_sub_pd(_mm256_loadu_pd(pfx + k), fx));
+			_mm256_storeu_pd(pfy + k, _mm256_sub_pd(_mm256_loadu_pd(pfy + k), fy));
+			_mm256_storeu_pd(ptorque + k, _mm256_sub_pd(_mm256_loadu_pd(ptorque + k), t));
+		}
+
+// Horizontal reduction of the lanes of particle i
+		_mm256_storeu_pd(lane_sum, fxi);
+		s->fx[i] += (lane_sum[0] + lane_sum[1]) + (lane_sum[2] + lane_sum[3]);
+		_mm256_storeu_pd(lane_sum, fyi);
+		s->fy[i] += (lane_sum[0] + lane_sum[1]) + (lane_sum[2] + lane_sum[3]);
+		_mm256_storeu_pd(lane_sum, ti);
+		s->torque[i] += (lane_sum[0] + lane_sum[1]) + (lane_sum[2] + lane_sum[3]);
+	}
+	cell_pack.Add_To(s, jb);
+}
+
+__attribute__((target("avx512f")))
+void Pair_Kernel_AVX512(Particle_Store* s, const int* ia, int na, const int* jb, int nb, bool self)
+{
+	Pair_Constants c;
+	cell_pack.Load(s, jb, nb);
+	Real* px = &(cell_pack.x[0]);
+	Real* py = &(cell_pack.y[0]);
+	Real* pvx = &(cell_pack.vx[0]);
+	Real* pvy = &(cell_pack.vy[0]);
+	Real* pfx = &(cell_pack.fx[0]);
+	Real* pfy = &(cell_pack.fy[0]);
+	Real* ptorque = &(cell_pack.torque[0]);
+
+	const __m512d lx2 = _mm512_set1_pd(Lx2);
+	const __m512d ly2 = _mm512_set1_pd(Ly2);
+	const __m512d half = _mm512_set1_pd(0.5);
+	const __m512d repulsion_radius = _mm512_set1_pd(c.repulsion_radius);
+	const __m512d sigma = _mm512_set1_pd(c.sigma);
+	const __m512d amplitude = _mm512_set1_pd(c.amplitude);
+	const __m512d sigma_over_cutoff13 = _mm512_set1_pd(c.sigma_over_cutoff13);
+	const __m512d alignment_radius = _mm512_set1_pd(c.alignment_radius);
+	const __m512d torque_coefficient = _mm512_set1_pd(c.torque_coefficient);
+	const __m512d one = _mm512_set1_pd(1.0);
+
+	for (int a = 0; a < na; a++)
+	{
+		int i = ia[a];
+		int start = self ? a+1 : 0; // The first partner in the pack
+		if (start >= nb)
+			continue;
+		const __m512d xi = _mm512_set1_pd(s->x[i]);
+		const __m512d yi = _mm512_set1_pd(s->y[i]);
+		const __m512d vxi = _mm512_set1_pd(s->vx[i]);
+		const __m512d vyi = _mm512_set1_pd(s->vy[i]);
+
+		__m512d fxi = _mm512_setzero_pd();
+		__m512d fyi = _mm512_setzero_pd();
+		__m512d ti = _mm512_setzero_pd();
+
+		for (int k = start & ~7; k < nb; k += 8)
+		{
+// Active lanes are start <= k+lane < nb
+			unsigned int bits = 0xFF;
+			if (k + 8 > nb)
+				bits &= (1u << (nb - k)) - 1;
+			if (k < start)
+				bits &= ~((1u << (start - k)) - 1);
+			const __mmask8 active = (__mmask8) bits;
+
+			__m512d dx = _mm512_sub_pd(xi, _mm512_loadu_pd(px + k));
+			__m512d dy = _mm512_sub_pd(yi, _mm512_loadu_pd(py + k));
+			#ifdef PERIODIC_BOUNDARY_CONDITION
+				dx = _mm512_sub_pd(dx, _mm512_mul_pd(lx2, _mm512_roundscale_pd(_mm512_add_pd(_mm512_div_pd(dx, lx2), half), _MM_FROUND_TO_NEG_INF)));
+				dy = _mm512_sub_pd(dy, _mm512_mul_pd(ly2, _mm512_roundscale_pd(_mm512_add_pd(_mm512_div_pd(dy, ly2), half), _MM_FROUND_TO_NEG_INF)));
+			#endif
+			__m512d d = _mm512_sqrt_pd(_mm512_add_pd(_mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy)));
+			d = _mm512_mask_blend_pd(active, one, d); // avoid a division by zero in the inactive lanes
+
+			__mmask8 repulsion_mask = _mm512_mask_cmp_pd_mask(active, d, repulsion_radius, _CMP_LT_OQ);
+			__mmask8 alignment_mask = _mm512_mask_cmp_pd_mask(active, d, alignment_radius, _CMP_LT_OQ);
+
+			__m512d sigma_over_d = _mm512_div_pd(sigma, d);
+			__m512d sigma_over_d2 = _mm512_mul_pd(sigma_over_d, sigma_over_d);
+			__m512d sigma_over_d4 = _mm512_mul_pd(sigma_over_d2, sigma_over_d2);
+			__m512d sigma_over_d8 = _mm512_mul_pd(sigma_over_d4, sigma_over_d4);
+			__m512d sigma_over_d13 = _mm512_mul_pd(_mm512_mul_pd(sigma_over_d8, sigma_over_d4), sigma_over_d);
+			__m512d strength = _mm512_maskz_div_pd(repulsion_mask, _mm512_mul_pd(amplitude, _mm512_sub_pd(sigma_over_d13, sigma_over_cutoff13)), d);
+			__m512d fx = _mm512_mul_pd(strength, dx);
+			__m512d fy = _mm512_mul_pd(strength, dy);
+
+			__m512d t = _mm512_maskz_mul_pd(alignment_mask, torque_coefficient, _mm512_sub_pd(_mm512_mul_pd(vxi, _mm512_loadu_pd(pvy + k)), _mm512_mul_pd(vyi, _mm512_loadu_pd(pvx + k))));
+
+			fxi = _mm512_add_pd(fxi, fx);
+			fyi = _mm512_add_pd(fyi, fy);
+			ti = _mm512_add_pd(ti, t);
+
+			_mm512_storeu_pd(pfx + k, _mm512_sub_pd(_mm512_loadu_pd(pfx + k), fx));
+			_mm512_storeu_pd(pfy + k, _mm512_sub_pd(_mm512_loadu_pd(pfy + k), fy));
+			_mm512_storeu_pd(ptorque + k, _mm512_sub_pd(_mm512_loadu_pd(ptorque + k), t));
+		}
+
+		s->fx[i] += _mm512_reduce_add_pd(fxi);
+		s->fy[i] += _mm512_reduce_add_pd(fyi);
+		s->torque[i] += _mm512_reduce_add_pd(ti);
+	}
+	cell_pack.Add_To(s, jb);
+}
+#endif
+
+Pair_Kernel pair_kernel = Pair_Kernel_Scalar; // The kernel that is used by cells
+
+// Choosing the widest kernel that the cpu supports. The name of the kernel is returned for the logs.
+const char* Select_Pair_Kernel()
+{
+	#ifdef SIMD_KERNEL_X86
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512f"))
+		{
+			pair_kernel = Pair_Kernel_AVX512;
+			return ("avx512");
+		}
+		if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+		{
+			pair_kernel = Pair_Kernel_AVX2;
+			return ("avx2");
+		}
+	#endif
+	pair_kernel = Pair_Kernel_Scalar;
+	return ("scalar");
+}
+
+#endif
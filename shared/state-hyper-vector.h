@@ -10,6 +10,9 @@ public:
 	Real growth;
 	BasicParticle0* particle;
 	gsl_rng* gsl_r;
+	#ifdef PHILOX_RNG
+		uint64_t rng_step; // With the counter based noise the state of the generator is only the step counter. gsl_r is kept for Rand.
+	#endif
 
 	
 	State_Hyper_Vector(int, int);
@@ -48,6 +51,9 @@ void State_Hyper_Vector::Init_Random_Generator(int seed)
 	T = gsl_rng_default;
 	gsl_r = gsl_rng_alloc (T);
 	gsl_rng_memcpy (gsl_r, C2DVector::gsl_r);
+	#ifdef PHILOX_RNG
+		rng_step = Philox::step;
+	#endif
 }
 
 State_Hyper_Vector::State_Hyper_Vector(int particle_number, int seed = 0) : N(particle_number)
@@ -60,6 +66,9 @@ State_Hyper_Vector::State_Hyper_Vector(const State_Hyper_Vector& sv) : N(sv.N)
 {
 	Init_Random_Generator(0);
 	gsl_rng_memcpy (gsl_r, sv.gsl_r);
+	#ifdef PHILOX_RNG
+		rng_step = sv.rng_step;
+	#endif
 	particle = new BasicParticle0[N];
 	for (int i = 0; i < N; i++)
 		particle[i] = sv.particle[i];
@@ -74,6 +83,9 @@ State_Hyper_Vector::~State_Hyper_Vector()
 State_Hyper_Vector& State_Hyper_Vector::operator= ( const State_Hyper_Vector& sv)
 {
 	gsl_rng_memcpy (gsl_r, sv.gsl_r);
+	#ifdef PHILOX_RNG
+		rng_step = sv.rng_step;
+	#endif
 	for (int i = 0; i < N; i++)
 		particle[i] = sv.particle[i];
 	return *this;
@@ -168,12 +180,20 @@ const Real State_Hyper_Vector::operator* (const State_Hyper_Vector& s1) const
 
 void State_Hyper_Vector::Set_C2DVector_Rand_Generator() const
 {
+	#ifdef PHILOX_RNG
+		Philox::step = rng_step;
+	#else
 	gsl_rng_memcpy (C2DVector::gsl_r, gsl_r);
+	#endif
 }
 
 void State_Hyper_Vector::Get_C2DVector_Rand_Generator()
 {
+	#ifdef PHILOX_RNG
+		rng_step = Philox::step;
+	#else
 	gsl_rng_memcpy (gsl_r, C2DVector::gsl_r);
+	#endif
 }
 
 void State_Hyper_Vector::Null()
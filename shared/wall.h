@@ -2,6 +2,9 @@
 #define _WALL_
 
 #include "c2dvector.h"
+#ifdef SOA_STORE
+	#include "particle-store.h"
+#endif
 
 class Wall{
 public:
@@ -22,6 +25,9 @@ public:
 	void Interact(VicsekParticle* p);
 	void Interact(ContinuousParticle* p);
 	void Interact(RepulsiveParticle* p);
+	#ifdef SOA_STORE
+		void Interact(Particle_Store* s, int i); // The same as the interaction with RepulsiveParticle for the i'th particle of the store
+	#endif
 };
 
 Wall::Wall()
@@ -226,8 +232,14 @@ void Wall::Interact(RepulsiveParticle* p)
 	{
 		C2DVector interaction_force;
 		dr /= d; 
-		Real r_c_w2 = RepulsiveParticle::r_c_w*RepulsiveParticle::r_c_w; 
-		interaction_force = dr * RepulsiveParticle::A_w * ( exp(- d / RepulsiveParticle::sigma_w ) * ( 1. / d2 + 1. / (RepulsiveParticle::sigma_w * d)) - exp(- RepulsiveParticle::r_c_w / RepulsiveParticle::sigma_w ) * ( 1. / r_c_w2 + 1. / (RepulsiveParticle::sigma_w * RepulsiveParticle::r_c_w)) );
+		#ifdef TABULATED_FORCE
+			if (d2 >= RepulsiveParticle::wall_table.s_min)
+				interaction_force = dr * RepulsiveParticle::wall_table(d2);
+			else
+				interaction_force = dr * RepulsiveParticle::A_w * RepulsiveParticle::wall_repulsion.Shape(d,d2);
+		#else
+			interaction_force = dr * RepulsiveParticle::A_w * RepulsiveParticle::wall_repulsion.Shape(d,d2);
+		#endif
 		p->f += interaction_force;
 	}
 
@@ -264,5 +276,55 @@ void Wall::Interact(RepulsiveParticle* p)
 	}
 }
 
+#ifdef SOA_STORE
+void Wall::Interact(Particle_Store* s, int i)
+{
+	C2DVector r;
+	r.x = s->x[i];
+	r.y = s->y[i];
+	C2DVector dr = Distance_Vector(r);
+	Real d2 = dr.Square();
+	Real d = sqrt(d2); 	// distance of the particle from wall 
+	if (d < RepulsiveParticle::r_c_w)
+	{
+		C2DVector interaction_force;
+		dr /= d; 
+		#ifdef TABULATED_FORCE
+			if (d2 >= RepulsiveParticle::wall_table.s_min)
+				interaction_force = dr * RepulsiveParticle::wall_table(d2);
+			else
+				interaction_force = dr * RepulsiveParticle::A_w * RepulsiveParticle::wall_repulsion.Shape(d,d2);
+		#else
+			interaction_force = dr * RepulsiveParticle::A_w * RepulsiveParticle::wall_repulsion.Shape(d,d2);
+		#endif
+		s->fx[i] += interaction_force.x;
+		s->fy[i] += interaction_force.y;
+	}
+
+	C2DVector dr_1 = r - point_1;
+	#ifdef PERIODIC_BOUNDARY_CONDITION
+		dr_1.Periodic_Transform();
+	#endif
+	if ((d < RepulsiveParticle::r_f_w) && (dr_1*direction < length) && (dr_1*direction > 0.))
+	{
+		Real torque_interaction;
+		// self propulsion direction of the particle, it is cached in the store
+		C2DVector self_propulsion_direction;
+		self_propulsion_direction.x = s->vx[i];
+		self_propulsion_direction.y = s->vy[i];
+		if (dr*self_propulsion_direction < 0.)
+		{
+			Real dtheta = s->theta[i] - theta;
+			torque_interaction = RepulsiveParticle::g_w*sin(dtheta)/PI;
+			dtheta -= 2*PI * ((int) (dtheta / (2*PI)));
+			if (dtheta < 0.)
+				dtheta += 2*PI; 		// 0 < dtheta < 2*PI
+			if ((dtheta > PI/2 && dtheta < 3*PI/2))
+				torque_interaction *= -1.;
+			s->torque[i] -= torque_interaction;
+		}
+	}
+}
+#endif
 
 #endif